@@ -0,0 +1,416 @@
+#include "Common.h"
+
+#include "Math.h"
+#include "World.h"
+#include "Config.h"
+#include "Manager.h"
+#include "Scenario.h"
+#include "EventQueue.h"
+#include "MessageStream.h"
+#include "BulletManager.h"
+
+#include <set>
+#include <chrono>
+#include <string>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+
+// runs the scenarios for a fixed simulated duration and prints their throughput as json.
+// log messages go to stderr so the output stays parseable
+struct BenchmarkOptions
+{
+  Array<Scenario::Type> Scenarios;
+  double Seconds = 10.0;
+  double Step = 1.0 / 60.0;
+  size_t Bullets = 1000;
+  size_t Walls = 200;
+  uint32_t Seed = 1;
+  size_t QueueEvents = 0;
+  std::string Output;
+};
+
+struct BenchmarkResult
+{
+  Scenario::Type Type;
+  size_t Steps = 0;
+  double WallSeconds = 0;
+  size_t Events = 0;
+  size_t Collisions = 0;
+  size_t CollisionUpdates = 0;
+  double CollisionUpdateSeconds = 0;
+  uint64_t PeakHistoryBytes = 0;
+  uint64_t PeakPoolBytes = 0;
+  size_t PeakQueueSize = 0;
+  size_t Bullets = 0;
+  size_t Walls = 0;
+};
+
+// EventQueue against the std::set it replaced, on the same seeded operations
+struct QueueResult
+{
+  size_t Events = 0;
+  size_t Operations = 0;
+  double HeapSeconds = 0;
+  double SetSeconds = 0;
+  bool SameOrder = false;
+};
+
+// what EventQueue needs of an event and nothing else
+struct QueueEvent
+{
+  tick_t Time;
+  uint64_t ID;
+  uint64_t QueueTicket = 0;
+};
+
+typedef std::shared_ptr<QueueEvent> QueueEventPointer;
+
+class SetQueue
+{
+public:
+
+  void Push(const QueueEventPointer& event)
+  {
+    Events.insert(event);
+  }
+
+  QueueEventPointer Pop()
+  {
+    QueueEventPointer event = *Events.begin();
+    Events.erase(Events.begin());
+    return event;
+  }
+
+  bool Remove(const QueueEventPointer& event)
+  {
+    return Events.erase(event) != 0;
+  }
+
+  size_t size() const
+  {
+    return Events.size();
+  }
+
+private:
+
+  struct Less
+  {
+    bool operator()(const QueueEventPointer& a, const QueueEventPointer& b) const
+    {
+      return (a->Time == b->Time) ? a->ID < b->ID : a->Time < b->Time;
+    }
+  };
+
+  std::set<QueueEventPointer, Less> Events;
+};
+
+class StandardErrorSink: public Manager, public MessageSink
+{
+public:
+
+  void WriteMessage(const std::string& message, const LogColor&, double) override
+  {
+    std::cerr << message << "\n";
+  }
+};
+
+static void PrintUsage(const char* binary)
+{
+  std::cerr << "usage: " << binary << " [--scenario all|NAME[,NAME...]] [--seconds S] [--step S]"
+    " [--bullets N] [--walls N] [--seed N] [--queue-events N] [--output FILE]\n";
+  std::cerr << "scenarios:";
+  for (int i = 0; i < Scenario::TYPE_COUNT; ++i)
+    std::cerr << " " << Scenario::GetName(Scenario::Type(i));
+  std::cerr << "\n";
+}
+
+static bool ParseScenarios(const std::string& value, Array<Scenario::Type>& scenarios)
+{
+  scenarios.clear();
+
+  if (value == "all")
+  {
+    for (int i = 0; i < Scenario::TYPE_COUNT; ++i)
+      scenarios.push_back(Scenario::Type(i));
+    return true;
+  }
+
+  size_t start = 0;
+  while (start <= value.size())
+  {
+    const size_t end = Min(value.find(',', start), value.size());
+
+    Scenario::Type type;
+    if (!Scenario::FindType(value.substr(start, end - start), type)) return false;
+    scenarios.push_back(type);
+
+    start = end + 1;
+  }
+
+  return scenarios.size() > 0;
+}
+
+static bool ParseOptions(int argc, char** argv, BenchmarkOptions& options)
+{
+  ParseScenarios("all", options.Scenarios);
+
+  for (int i = 1; i < argc; ++i)
+  {
+    if (i + 1 >= argc) return false;
+
+    const char* name = argv[i];
+    const char* value = argv[++i];
+
+    if (!strcmp(name, "--scenario")) { if (!ParseScenarios(value, options.Scenarios)) return false; }
+    else if (!strcmp(name, "--seconds")) options.Seconds = atof(value);
+    else if (!strcmp(name, "--step")) options.Step = atof(value);
+    else if (!strcmp(name, "--bullets")) options.Bullets = strtoull(value, nullptr, 10);
+    else if (!strcmp(name, "--walls")) options.Walls = strtoull(value, nullptr, 10);
+    else if (!strcmp(name, "--seed")) options.Seed = uint32_t(strtoul(value, nullptr, 10));
+    else if (!strcmp(name, "--queue-events")) options.QueueEvents = strtoull(value, nullptr, 10);
+    else if (!strcmp(name, "--output")) options.Output = value;
+    else return false;
+  }
+
+  return options.Step > 0 && options.Seconds >= 0;
+}
+
+static BenchmarkResult Run(Scenario::Type type, const BenchmarkOptions& options)
+{
+  BenchmarkResult result;
+  result.Type = type;
+
+  World world;
+  World::Reset();
+
+  BulletManager bullet_manager;
+  StandardErrorSink log_sink;
+  world.Managers += &bullet_manager;
+  world.Managers += &log_sink;
+
+  Scenario scenario(type, options.Seed, options.Bullets, options.Walls);
+
+  // the scenarios run one after another, the next one shouldn't inherit this
+  const bool destroy_walls = Config::DestroyWallsOnCollision;
+  Config::DestroyWallsOnCollision = scenario.DestroysWalls();
+
+  scenario.Build(world);
+
+  const auto start_time = std::chrono::steady_clock::now();
+
+  // step times are multiples of the step so they don't drift
+  const tick_t step_ticks = Max(Ticks::FromSeconds(options.Step), tick_t(1));
+  const tick_t end_time = Ticks::FromSeconds(options.Seconds);
+  const size_t step_count = size_t((end_time + step_ticks - 1) / step_ticks);
+
+  for (size_t step = 1; step <= step_count; ++step)
+  {
+    world.Simulate(Min(tick_t(step) * step_ticks, end_time));
+    scenario.Update(world);
+
+    result.PeakHistoryBytes = Max(result.PeakHistoryBytes, world.History.GetLogSize());
+    result.PeakPoolBytes = Max(result.PeakPoolBytes, world.History.GetTotalSize());
+  }
+
+  result.Steps = step_count;
+
+  result.WallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+
+  result.Events = world.History.ProcessedEvents;
+  result.PeakQueueSize = world.History.PeakQueueSize;
+  result.Collisions = bullet_manager.Stats.CollisionCount;
+  result.CollisionUpdates = bullet_manager.Stats.CollisionUpdates;
+  result.CollisionUpdateSeconds = bullet_manager.Stats.CollisionUpdateSeconds;
+  result.Bullets = world.Bullets.size();
+  result.Walls = world.Walls.size();
+
+  world.Managers.clear();
+
+  Config::DestroyWallsOnCollision = destroy_walls;
+
+  return result;
+}
+
+// fills the queue, cancels a quarter of the events, then pops the earliest and pushes one later
+// as many times as there are events, and drains it. returns a hash of the order events came out in
+template<typename Q>
+static uint64_t RunQueue(Q& queue, const Array<QueueEventPointer>& events, const Array<size_t>& cancels, const Array<tick_t>& delays, size_t& operations)
+{
+  const size_t count = delays.size();
+  uint64_t hash = 0;
+  operations = 0;
+
+  for (size_t i = 0; i < count; ++i, ++operations)
+    queue.Push(events[i]);
+
+  for (size_t index : cancels)
+  {
+    queue.Remove(events[index]);
+    ++operations;
+  }
+
+  for (size_t i = 0; i < count && queue.size(); ++i, operations += 2)
+  {
+    const QueueEventPointer event = queue.Pop();
+    hash = hash * 31 + event->ID;
+
+    events[count + i]->Time = event->Time + delays[i];
+    queue.Push(events[count + i]);
+  }
+
+  for (; queue.size(); ++operations)
+    hash = hash * 31 + queue.Pop()->ID;
+
+  return hash;
+}
+
+static QueueResult RunQueues(const BenchmarkOptions& options)
+{
+  QueueResult result;
+  result.Events = options.QueueEvents;
+
+  const size_t count = options.QueueEvents;
+
+  // xorshift32, as the scenarios
+  uint32_t state = options.Seed * 2654435761u ^ 0x9E3779B9u;
+  if (!state) state = 1;
+  auto next = [&state]()
+  {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+  };
+
+  // up to 10 s ahead, and later events up to 1 s after the one popped
+  Array<QueueEventPointer> events;
+  events.reserve(2 * count);
+  for (size_t i = 0; i < 2 * count; ++i)
+    events.push_back(std::make_shared<QueueEvent>(QueueEvent{ tick_t(next() % (10 * Ticks::PerSecond)), i }));
+
+  Array<size_t> cancels;
+  for (size_t i = 0; i < count / 4; ++i)
+    cancels.push_back(next() % count);
+
+  Array<tick_t> delays;
+  for (size_t i = 0; i < count; ++i)
+    delays.push_back(tick_t(next() % Ticks::PerSecond));
+
+  // the hold phase sets the times of the later events, both queues set the same ones
+  EventQueue<QueueEvent> heap;
+  auto start_time = std::chrono::steady_clock::now();
+  const uint64_t heap_hash = RunQueue(heap, events, cancels, delays, result.Operations);
+  result.HeapSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+
+  SetQueue set;
+  start_time = std::chrono::steady_clock::now();
+  const uint64_t set_hash = RunQueue(set, events, cancels, delays, result.Operations);
+  result.SetSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+
+  result.SameOrder = heap_hash == set_hash;
+
+  return result;
+}
+
+static double PerSecond(double count, double seconds)
+{
+  return seconds > 0 ? count / seconds : 0;
+}
+
+static void WriteJson(std::ostream& stream, const BenchmarkOptions& options, const Array<BenchmarkResult>& results, const QueueResult& queue)
+{
+  stream.precision(10);
+
+  stream << "{\n";
+  stream << "  \"seed\": " << options.Seed << ",\n";
+  stream << "  \"simulated_seconds\": " << options.Seconds << ",\n";
+  stream << "  \"step\": " << options.Step << ",\n";
+  stream << "  \"bullets\": " << options.Bullets << ",\n";
+  stream << "  \"walls\": " << options.Walls << ",\n";
+  stream << "  \"scenarios\": [";
+
+  for (size_t i = 0; i < results.size(); ++i)
+  {
+    const BenchmarkResult& result = results[i];
+
+    stream << (i ? ",\n" : "\n") << "    {\n";
+    stream << "      \"name\": \"" << Scenario::GetName(result.Type) << "\",\n";
+    stream << "      \"steps\": " << result.Steps << ",\n";
+    stream << "      \"wall_seconds\": " << result.WallSeconds << ",\n";
+    stream << "      \"events\": " << result.Events << ",\n";
+    stream << "      \"events_per_second\": " << PerSecond(double(result.Events), result.WallSeconds) << ",\n";
+    stream << "      \"collisions\": " << result.Collisions << ",\n";
+    stream << "      \"collisions_per_second\": " << PerSecond(double(result.Collisions), result.WallSeconds) << ",\n";
+    stream << "      \"collision_updates\": " << result.CollisionUpdates << ",\n";
+    stream << "      \"ns_per_collision_update\": "
+      << (result.CollisionUpdates ? result.CollisionUpdateSeconds * 1e9 / result.CollisionUpdates : 0.0) << ",\n";
+    stream << "      \"peak_history_bytes\": " << result.PeakHistoryBytes << ",\n";
+    stream << "      \"peak_pool_bytes\": " << result.PeakPoolBytes << ",\n";
+    stream << "      \"peak_queue_depth\": " << result.PeakQueueSize << ",\n";
+    stream << "      \"final_bullets\": " << result.Bullets << ",\n";
+    stream << "      \"final_walls\": " << result.Walls << "\n";
+    stream << "    }";
+  }
+
+  stream << "\n  ]";
+
+  if (queue.Events)
+  {
+    stream << ",\n  \"event_queue\": {\n";
+    stream << "    \"events\": " << queue.Events << ",\n";
+    stream << "    \"operations\": " << queue.Operations << ",\n";
+    stream << "    \"heap_seconds\": " << queue.HeapSeconds << ",\n";
+    stream << "    \"set_seconds\": " << queue.SetSeconds << ",\n";
+    stream << "    \"heap_ns_per_operation\": " << queue.HeapSeconds * 1e9 / double(queue.Operations) << ",\n";
+    stream << "    \"set_ns_per_operation\": " << queue.SetSeconds * 1e9 / double(queue.Operations) << ",\n";
+    stream << "    \"same_order\": " << (queue.SameOrder ? "true" : "false") << "\n";
+    stream << "  }";
+  }
+
+  stream << "\n}\n";
+}
+
+int main(int argc, char** argv)
+{
+  Config::BinaryPath = argv[0];
+
+  BenchmarkOptions options;
+  if (!ParseOptions(argc, argv, options))
+  {
+    PrintUsage(argv[0]);
+    return 1;
+  }
+
+  Array<BenchmarkResult> results;
+  for (Scenario::Type type : options.Scenarios)
+  {
+    std::cerr << Scenario::GetName(type) << "..." << std::endl;
+    results.push_back(Run(type, options));
+  }
+
+  QueueResult queue;
+  if (options.QueueEvents)
+  {
+    std::cerr << "event queue..." << std::endl;
+    queue = RunQueues(options);
+  }
+
+  if (options.Output.empty())
+  {
+    WriteJson(std::cout, options, results, queue);
+    return 0;
+  }
+
+  std::ofstream file(options.Output);
+  if (!file)
+  {
+    std::cerr << "can't write " << options.Output << "\n";
+    return 1;
+  }
+
+  WriteJson(file, options, results, queue);
+  return 0;
+}
@@ -38,7 +38,7 @@ Set<Wall::id_t> Bullet::ApplyCollision()
 
     for (Wall* wall : hit_walls)
     {
-      double hit_time = this->IntersectWall(*wall, point, normal, World::Time());
+      tick_t hit_time = this->IntersectWall(*wall, point, normal, World::Time());
       if (hit_time != Collision.Time) continue;
       hits = true;
       normal_sum += normal;
@@ -58,12 +58,13 @@ Set<Wall::id_t> Bullet::ApplyCollision()
       << "bullet[" << ID << "] hit "
       << (Collision.WallIDs.size() > 1 ? "walls" : "wall")
       << " " << String::Join(Collision.WallIDs)
-      << " at " << World::Time()
+      << " at " << Ticks::ToSeconds(World::Time())
       << " normal: " << Collision.Normal.Normalized()
       << " direction: " << Direction << " -> " << Collision.Direction;
   }
 
-  Time = Collision.Time;
+  MoveTo(Collision.Time);
+
   Location = Collision.Location;
   Direction = Collision.Direction;
 
@@ -76,33 +77,69 @@ Bullet::Bullet(const Bullet * data) :
   Bullet(*data)
 {}
 
-Bullet::Bullet(const id_t ID, const float2 & location, const float2 & direction, const float speed, const double time, const float lifetime) :
+Bullet::Bullet(const id_t ID, const float2 & location, const float2 & direction, const float speed, const tick_t time, const float lifetime) :
   Time(time), ID(ID), Location(location), Direction(direction), Speed(speed), Lifetime(lifetime)
 {
 }
 
-float2 Bullet::GetLocation(double time) const
+float2 Bullet::GetLocation(tick_t time) const
 {
-  return Location + Direction * Speed * (time - Time);
+  return Location + Direction * Speed * Ticks::ToSeconds(time - Time);
 }
 
-double Bullet::IntersectWall(const Wall& wall, float2& point, float2& normal, double time) const
+void Bullet::MoveTo(tick_t time)
 {
-  float2 location = Location + Direction * Speed * Max(0.0, time - Time);
-  if (isnan(location.x))
-  {
-    LOG << "Bullet::IntersectWall location.x is not a number";
-  }
-  if (Math2D::CircleLineIntersection(wall.Ends, location, Direction, Config::BulletRadius, 10000.0f, point, normal))
-  {
-    if (isnan(point.x))
-    {
-      LOG << "Bullet::IntersectWall point.x is not a number";
-    }
-    return time + location.DistanceTo(point) / Speed; // seconds
-  }
+  if (Lifetime > 0)
+    Lifetime = Max(Lifetime - float(Ticks::ToSeconds(time - Time)), std::numeric_limits<float>::min());
+
+  Location = GetLocation(time);
+  Time = time;
+}
+
+tick_t Bullet::GetExpiryTime() const
+{
+  const tick_t end_of_life = Lifetime > 0 ? Ticks::After(Time, Lifetime) : Ticks::Infinity;
+
+  // a bullet already past its end, like one outside bounds that just shrank, expires now
+  // rather than back when it was last updated, which would rewind the world
+  const tick_t now = World::Time();
+
+  if (Speed <= 0) return Max(end_of_life, now);
+
+  // distance to the bounds along the current direction, a bounce on the way reschedules it
+  const float bounds = float(Config::WorldBounds);
+
+  float distance = std::numeric_limits<float>::infinity();
+  if (Direction.x != 0) distance = Min(distance, ((Direction.x > 0 ? bounds : -bounds) - Location.x) / Direction.x);
+  if (Direction.y != 0) distance = Min(distance, ((Direction.y > 0 ? bounds : -bounds) - Location.y) / Direction.y);
+
+  return Max(Min(end_of_life, Ticks::After(Time, Max(distance, 0.0f) / Speed)), now);
+}
+
+LineSegment Bullet::GetPath() const
+{
+  if (Collision.Hits && Collision.WallIDs.size())
+    return { Location, Collision.Location };
+
+  // nothing can be hit once the bullet expired, so with no horizon the path doesn't run the whole Range
+  const tick_t end_time = Min(Collision.HorizonTime, GetExpiryTime());
+  if (end_time != Ticks::Infinity)
+    return { Location, GetLocation(end_time) };
+
+  return { Location, Location + Direction * Range };
+}
+
+tick_t Bullet::GetHitTime(float distance, tick_t time) const
+{
+  return Ticks::After(time, distance / Speed);
+}
+
+tick_t Bullet::IntersectWall(const Wall& wall, float2& point, float2& normal, tick_t time) const
+{
+  const float distance = Math2D::RayCapsuleIntersection(wall.Ends, GetLocation(Max(time, Time)), Direction,
+    float(Config::BulletRadius), Range, point, normal);
 
-  return std::numeric_limits<double>::infinity();
+  return GetHitTime(distance, time);
 }
 
 std::ostream& operator<<(std::ostream& stream, const Bullet& bullet)
@@ -111,7 +148,7 @@ std::ostream& operator<<(std::ostream& stream, const Bullet& bullet)
     << "Bullet[ID=" << bullet.ID
     << ",Location=" << bullet.Location
     << ",Direction=" << bullet.Direction
-    << ",NextHit[Time=" << bullet.Collision.Time
+    << ",NextHit[Time=" << Ticks::ToSeconds(bullet.Collision.Time)
     << ",WallIDs=[" << String::Join(bullet.Collision.WallIDs) << "]"
     << ",Location=" << bullet.Collision.Location
     << ",Normal=" << bullet.Collision.Direction
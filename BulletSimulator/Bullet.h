@@ -3,10 +3,13 @@
 #include "Set.h"
 #include "Wall.h"
 #include "Types.h"
+#include "Tick.h"
 #include "Vector2.h"
-#include "Timestamp.h"
 #include "ProtocolEnums.h"
 
+#include <limits>
+#include <ostream>
+
 
 #pragma pack(push, 4)
 
@@ -15,23 +18,33 @@ struct Bullet
 public:
 
   typedef uint32_t id_t;
+
+  static constexpr float Range = 10000.0f;
   
-  double Time;
+  tick_t Time;
   id_t ID = 0;
 
   float2 Location;
   float2 Direction;
 
   float Speed = 0;
+
+  // remaining from Time, 0 for no limit
   float Lifetime = 0;
 
   struct {
     bool Hits = false;
-    double Time;
+    tick_t Time;
     Set<Wall::id_t> WallIDs;
     float2 Location;
     float2 Direction;
     float2 Normal;
+
+    // when nothing is hit, the search resumes from where the bullet is at this time
+    tick_t HorizonTime = Ticks::Infinity;
+
+    // of the search event scheduled last, events carrying another one are stale
+    uint32_t Generation = 0;
   } Collision;
   
 public:
@@ -40,14 +53,26 @@ public:
 
   explicit Bullet(const Bullet* data);
 
-  Bullet(const id_t ID, const float2& location, const float2& direction, const float speed, const double time, const float lifetime);
+  Bullet(const id_t ID, const float2& location, const float2& direction, const float speed, const tick_t time, const float lifetime);
 
   Set<Wall::id_t> ApplyCollision();
 
-  float2 GetLocation(double time) const;
+  float2 GetLocation(tick_t time) const;
+
+  // moves the bullet along its current direction, Time becomes time
+  void MoveTo(tick_t time);
+
+  // end of the lifetime or leaving the world bounds, whichever comes first
+  tick_t GetExpiryTime() const;
+
+  // straight part of the trajectory from the last bounce to the next hit, the horizon or the expiry
+  LineSegment GetPath() const;
+
+  // time when the bullet has traveled distance since its location at time
+  tick_t GetHitTime(float distance, tick_t time) const;
 
   // returns intersection time
-  double IntersectWall(const struct Wall& wall, float2& point, float2& reflection, double time) const;
+  tick_t IntersectWall(const struct Wall& wall, float2& point, float2& reflection, tick_t time) const;
 
   bool operator<(const Bullet& other) const
   {
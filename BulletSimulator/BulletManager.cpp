@@ -5,11 +5,11 @@
 #include "Config.h"
 #include "Logger.h"
 #include "StringUtils.h"
+#include "CollisionKernel.h"
 #include "Vector2Stream.h"
-#include "WindowManager.h"
-#include "NetworkManager.h"
 
 #include <mutex>
+#include <chrono>
 #include <iterator>
 #include <algorithm>
 #include <execution>
@@ -22,7 +22,7 @@ static struct {
 
 struct Collision
 {
-  double Time = std::numeric_limits<double>::infinity();
+  tick_t Time = Ticks::Infinity;
   uint32_t WallID = 0;
   float2 Location;
   float2 Normal;
@@ -48,33 +48,98 @@ float2 GetReflectionNormal(const Set<Collision>& collisions)
   return sum;
 };
 
-void BulletManager::UpdateBulletCollision(Bullet& bullet, double time)
+void BulletManager::FindBulletCollision(Bullet& bullet, tick_t time)
 {
   if (Config::LogCollisions)
-    LOG << "UpdateBulletNextHit: bullet[" << bullet.ID << "] at " << time << " last wall ids: [" << String::Join(bullet.Collision.WallIDs, ", ") << "]";
+    LOG << "UpdateBulletNextHit: bullet[" << bullet.ID << "] at " << Ticks::ToSeconds(time) << " last wall ids: [" << String::Join(bullet.Collision.WallIDs, ", ") << "]";
+
+  World& world = World::Get();
 
-  Collision current;
   Set<Collision> collisions;
+  Set<Wall::id_t> tested_walls;
+
+  const float2 origin = bullet.GetLocation(Max(time, bullet.Time));
 
-  World::Get().Walls.ForEach([&bullet, time, &collisions](const Wall& wall)
+  float range = GetCollisionRange();
+
+  CollisionKernel::Batch batch;
+  CollisionKernel::Result result;
+  Wall::id_t batch_wall_ids[CollisionKernel::Width];
+
+  auto test_batch = [&]()
   {
-    Collision current;
-    current.Time = bullet.IntersectWall(wall, current.Location, current.Normal, time);
+    if (!batch.Count) return;
 
-    if (bullet.Collision.WallIDs.Contains(wall.ID)) return;
-    if (isinf(current.Time)) return;
-    current.WallID = wall.ID;
-    collisions += current;
-  });
+    CollisionKernel::Intersect(batch, float(Config::BulletRadius), range, result);
+
+    for (size_t lane = 0; lane < batch.Count; ++lane)
+    {
+      if (!result.Hits(lane)) continue;
+
+      Collision current;
+      current.Time = bullet.GetHitTime(result.Distance[lane], time);
+      current.WallID = batch_wall_ids[lane];
+      current.Location = result.GetPoint(lane);
+      current.Normal = result.GetNormal(lane);
+      collisions += current;
+    }
+
+    batch.Clear();
+  };
+
+  auto test_walls = [&](const Array<Wall::id_t>& wall_ids)
+  {
+    for (Wall::id_t wall_id : wall_ids)
+    {
+      if (bullet.Collision.WallIDs.Contains(wall_id)) continue;
+      if (tested_walls.Contains(wall_id)) continue;
+      tested_walls += wall_id;
+
+      const Wall* wall = world.Walls.Get(wall_id);
+      if (!wall) continue;
+
+      batch_wall_ids[batch.Add(origin, bullet.Direction, wall->Ends)] = wall_id;
+
+      if (batch.IsFull()) test_batch();
+    }
+
+    test_batch();
+  };
+
+  if (Config::EnableCellTraversal)
+  {
+    // walls touching the cell within the bullet radius are registered in it,
+    // so nothing past its boundary can be hit before the bullet crosses it
+    float exit_distance;
+    const Array<Wall::id_t>* wall_ids = world.WallIndex.GetCell(origin, bullet.Direction, exit_distance);
+    range = Min(range, exit_distance);
+    if (wall_ids) test_walls(*wall_ids);
+  }
+  else
+  {
+    world.WallIndex.Raycast(origin, bullet.Direction, range,
+      [&](const Array<Wall::id_t>& wall_ids, float exit_distance)
+    {
+      test_walls(wall_ids);
+
+      // hits beyond this cell can't be closer than the ones already found
+      return !collisions.size() || collisions.First().Time >= bullet.GetHitTime(exit_distance, time);
+    });
+  }
   
   if (!collisions.size())
   {
     bullet.Collision.Hits = false;
+    bullet.Collision.HorizonTime = (range < Bullet::Range)
+      ? bullet.GetHitTime(range, Max(time, bullet.Time))
+      : Ticks::Infinity;
     return;
   }
 
+  bullet.Collision.HorizonTime = Ticks::Infinity;
+
   Collision min_collision = collisions.First();
-  double min_collision_time = min_collision.Time;
+  const tick_t min_collision_time = min_collision.Time;
 
   Set<Wall::id_t> min_wall_ids;
   Set<Collision> min_collisions;
@@ -88,7 +153,7 @@ void BulletManager::UpdateBulletCollision(Bullet& bullet, double time)
   }
 
   if (Config::LogCollisions)
-    LOG << "UpdateBulletNextHit: min_wall_ids: [" << String::Join(min_wall_ids, ", ") << "] at " << min_collision_time;
+    LOG << "UpdateBulletNextHit: min_wall_ids: [" << String::Join(min_wall_ids, ", ") << "] at " << Ticks::ToSeconds(min_collision_time);
 
   if (!min_wall_ids.size())
   {
@@ -96,7 +161,8 @@ void BulletManager::UpdateBulletCollision(Bullet& bullet, double time)
     return;
   }
 
-  if (Abs(bullet.Collision.Time - min_collision_time) > 0.0001)
+  // ticks are exact, only a hit at the very time of the last one joins it
+  if (bullet.Collision.Time != min_collision_time)
   {
     bullet.Collision.WallIDs.clear();
     bullet.Collision.Normal = 0;
@@ -118,9 +184,10 @@ void BulletManager::UpdateBulletCollision(Bullet& bullet, double time)
   
   bullet.Collision.Normal += GetReflectionNormal(min_collisions);  
 
+  // the normal may have been summed with the one of the same wall found at the same time
   if (bullet.Collision.WallIDs.size() == 1)
   {
-    bullet.Collision.Direction = bullet.Direction.Reflect(bullet.Collision.Normal);
+    bullet.Collision.Direction = bullet.Direction.Reflect(bullet.Collision.Normal.Normalized());
   }
   else
   {
@@ -128,15 +195,63 @@ void BulletManager::UpdateBulletCollision(Bullet& bullet, double time)
   }
 }
 
-double BulletManager::GetNearestCollision(const Array<Bullet>& bullets, Bullet const*& hit_bullet)
+float BulletManager::GetCollisionRange()
+{
+  return Config::CollisionHorizon > 0
+    ? Min(float(Config::CollisionHorizon), Bullet::Range)
+    : Bullet::Range;
+}
+
+void BulletManager::UpdateBulletCollision(Bullet& bullet, tick_t time)
+{
+  const auto start_time = std::chrono::steady_clock::now();
+
+  FindBulletCollision(bullet, time);
+  World::Get().UpdateBullet(bullet);
+
+  Stats.CollisionUpdates++;
+  Stats.CollisionUpdateSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+}
+
+void BulletManager::FindBulletCollisions(const Array<Bullet*>& bullets, const Array<tick_t>& times)
+{
+  const auto start_time = std::chrono::steady_clock::now();
+
+  if (Config::LogCollisions || bullets.size() < Config::ParallelCollisionBatchSize)
+  {
+    for (size_t i = 0; i < bullets.size(); ++i)
+      FindBulletCollision(*bullets[i], times[i]);
+  }
+  else
+  {
+    // walls and the wall index are only read here, each task writes to its own bullet
+    std::for_each(std::execution::par, bullets.begin(), bullets.end(), [&](Bullet* const& bullet)
+    {
+      const size_t index = &bullet - bullets.data();
+      FindBulletCollision(*bullet, times[index]);
+    });
+  }
+
+  Stats.CollisionUpdates += bullets.size();
+  Stats.CollisionUpdateSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+}
+
+void BulletManager::UpdateBulletCollisions(const Array<Bullet*>& bullets, const Array<tick_t>& times)
 {
-  const double time = World::Get().CurrentTime;
+  FindBulletCollisions(bullets, times);
 
-  double min_collision_time = std::numeric_limits<double>::infinity();
+  World& world = World::Get();
+  for (Bullet* bullet : bullets)
+    world.UpdateBullet(*bullet);
+}
+
+tick_t BulletManager::GetNearestCollision(const Array<Bullet>& bullets, Bullet const*& hit_bullet)
+{
+  tick_t min_collision_time = Ticks::Infinity;
 
   for (const Bullet& bullet : bullets)
   {
-    if (isinf(bullet.Collision.Time)) continue;
+    if (bullet.Collision.Time == Ticks::Infinity) continue;
 
     if (bullet.Collision.Time < min_collision_time)
     {
@@ -152,7 +267,7 @@ void BulletManager::Update(double delta_time)
 {
   World& world = World::Get();
 
-  //world.Simulate(world.CurrentTime + delta_time);
+  //world.Simulate(world.CurrentTick + Ticks::FromSeconds(delta_time));
 }
 
 Bullet::id_t BulletManager::GetNextBulletID()
@@ -187,7 +302,7 @@ void BulletManager::UpdateNextWallID(Wall::id_t value)
   Config::LastWallId = Max(Config::LastWallId, value);
 }
 
-void BulletManager::Fire(const float2& pos, const float2& dir, float speed, double time, float life_time)
+Bullet BulletManager::Fire(const float2& pos, const float2& dir, float speed, tick_t time, float life_time)
 {
   World& world = World::Get();
 
@@ -195,47 +310,116 @@ void BulletManager::Fire(const float2& pos, const float2& dir, float speed, doub
 
   world.History.ScheduleEvent<EventsHistory::Add<Bullet>>(time, bullet, false);
 
-  world.GetManager<NetworkManager>()->Fire(bullet);
+  return bullet;
 }
 
 Set<Bullet*> BulletManager::WallAdded(const Wall& wall)
 {
   World& world = World::Get();
 
-  double time;
+  tick_t time;
   float2 intersection;
   float2 normal;
 
-  Set<Bullet*> updated_bullets;
-  world.Bullets.ForEach([&](Bullet& bullet)
+  Set<Bullet::id_t> bullet_ids;
+  world.BulletPathIndex.Query(wall.Ends, Config::BulletRadius, [&bullet_ids](const Bullet::id_t& id)
   {
-    time = bullet.IntersectWall(wall, intersection, normal, world.CurrentTime);
+    bullet_ids += id;
+  });
 
-    if (isinf(time)) return;
+  Array<Bullet*> candidates;
+  for (Bullet::id_t bullet_id : bullet_ids)
+  {
+    Bullet* bullet_ptr = world.Bullets.Get(bullet_id);
+    if (bullet_ptr) candidates.push_back(bullet_ptr);
+  }
 
-    if (bullet.Collision.Hits && bullet.Collision.WallIDs.size() && time > bullet.Collision.Time) return;
+  CollisionKernel::Batch batch;
+  CollisionKernel::Result result;
 
-    if (time < wall.Time.GetTime(world.CurrentTime)) return;
+  Set<Bullet*> updated_bullets;
+  for (size_t first = 0; first < candidates.size(); first += CollisionKernel::Width)
+  {
+    const size_t count = Min(CollisionKernel::Width, candidates.size() - first);
 
-    updated_bullets += &bullet;
+    batch.Clear();
+    for (size_t i = 0; i < count; ++i)
+    {
+      const Bullet& bullet = *candidates[first + i];
+      batch.Add(bullet.GetLocation(Max(world.CurrentTick, bullet.Time)), bullet.Direction, wall.Ends);
+    }
 
-    bullet.Collision.Hits = true;
+    CollisionKernel::Intersect(batch, float(Config::BulletRadius), Bullet::Range, result);
 
-    if (!bullet.Collision.Hits || time < bullet.Collision.Time || !bullet.Collision.WallIDs.size())
-    {
-      bullet.Collision.WallIDs.clear();
-      bullet.Collision.Normal = normal;
-    } 
-    else if (bullet.Collision.WallIDs.size())
+    for (size_t lane = 0; lane < count; ++lane)
     {
-      bullet.Collision.Normal += normal;
+      if (!result.Hits(lane)) continue;
+
+      Bullet& bullet = *candidates[first + lane];
+
+      time = bullet.GetHitTime(result.Distance[lane], world.CurrentTick);
+      intersection = result.GetPoint(lane);
+      normal = result.GetNormal(lane);
+
+      if (bullet.Collision.Hits && bullet.Collision.WallIDs.size() && time > bullet.Collision.Time) continue;
+
+      if (time < wall.Time) continue;
+
+      // walls past the horizon weren't searched yet, the hit may be behind one of them
+      if (!bullet.Collision.Hits && time > bullet.Collision.HorizonTime) continue;
+
+      updated_bullets += &bullet;
+
+      bullet.Collision.Hits = true;
+      bullet.Collision.HorizonTime = Ticks::Infinity;
+
+      if (!bullet.Collision.Hits || time < bullet.Collision.Time || !bullet.Collision.WallIDs.size())
+      {
+        bullet.Collision.WallIDs.clear();
+        bullet.Collision.Normal = normal;
+      } 
+      else if (bullet.Collision.WallIDs.size())
+      {
+        bullet.Collision.Normal += normal;
+      }
+
+      bullet.Collision.WallIDs += wall.ID;
+      bullet.Collision.Time = time;
+      bullet.Collision.Location = intersection;
+      bullet.Collision.Direction = bullet.Direction.Reflect(bullet.Collision.Normal.Normalized());
+
+      world.UpdateBullet(bullet);
     }
+  }
 
-    bullet.Collision.WallIDs += wall.ID;
-    bullet.Collision.Time = time;
-    bullet.Collision.Location = intersection;
-    bullet.Collision.Direction = bullet.Direction.Reflect(bullet.Collision.Normal.Normalized());
-  });
+  return updated_bullets;
+}
+
+Set<Bullet*> BulletManager::WallRemoved(Wall::id_t wall_id)
+{
+  World& world = World::Get();
+
+  const Set<Bullet::id_t>* targets = world.GetWallTargets(wall_id);
+
+  if (!targets) return {};
+
+  // updating the bullets changes the index
+  const Set<Bullet::id_t> bullet_ids = *targets;
+
+  Set<Bullet*> updated_bullets;
+  for (Bullet::id_t bullet_id : bullet_ids)
+  {
+    Bullet* bullet = world.Bullets.Get(bullet_id);
+    if (!bullet) continue;
+
+    bullet->Collision.Hits = false;
+    bullet->Collision.WallIDs.clear();
+    bullet->Collision.Time = Ticks::Infinity;
+
+    UpdateBulletCollision(*bullet, world.CurrentTick);
+
+    updated_bullets += bullet;
+  }
 
   return updated_bullets;
 }
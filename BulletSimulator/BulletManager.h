@@ -11,11 +11,21 @@ public:
   
   void Update(double delta_time) override;
 
-  void Fire(const float2& pos, const float2& dir, float speed, double time, float life_time);
+  Bullet Fire(const float2& pos, const float2& dir, float speed, tick_t time, float life_time);
 
   Set<struct Bullet*> WallAdded(const struct Wall& wall);
 
-  void UpdateBulletCollision(Bullet& bullet, double time = World::Get().CurrentTime);
+  // recomputes next collisions of bullets that were about to hit the wall
+  Set<struct Bullet*> WallRemoved(Wall::id_t wall_id);
+
+  void UpdateBulletCollision(Bullet& bullet, tick_t time = World::Get().CurrentTick);
+
+  // computes next collisions of many bullets in parallel, walls must not change meanwhile.
+  // bullets don't have to be in the world, indices are left untouched
+  void FindBulletCollisions(const Array<Bullet*>& bullets, const Array<tick_t>& times);
+
+  // same as UpdateBulletCollision for each bullet, indices are updated in the given order
+  void UpdateBulletCollisions(const Array<Bullet*>& bullets, const Array<tick_t>& times);
   
   Bullet::id_t GetNextBulletID();
   Wall::id_t GetNextWallID();
@@ -26,12 +36,21 @@ public:
   {
     size_t CollisionCount = 0;
     float LastUpdateDeltaTime = 0;
+
+    // bullets whose next collision was searched for and the time it took
+    size_t CollisionUpdates = 0;
+    double CollisionUpdateSeconds = 0;
   } Stats;
 
   uint32_t LastBulletID = 0;
 
 private:
 
-  double GetNearestCollision(const Array<Bullet>& bullets, Bullet const*& hit_bullet);
+  void FindBulletCollision(Bullet& bullet, tick_t time);
+
+  // look ahead distance of a collision search
+  static float GetCollisionRange();
+
+  tick_t GetNearestCollision(const Array<Bullet>& bullets, Bullet const*& hit_bullet);
 };
 
@@ -0,0 +1,194 @@
+#pragma once
+
+#include "Array.h"
+#include "Types.h"
+#include "Bullet.h"
+
+#include <limits>
+#include <type_traits>
+#include <unordered_map>
+
+
+// dense bullet storage: bullets live in a contiguous array addressed by slot,
+// ids map to slots and removal moves the last bullet into the freed slot.
+// fields read by per-frame passes are mirrored into separate arrays,
+// call Update after modifying a bullet obtained through Get
+class BulletStore
+{
+public:
+
+  Bullet& Add(const Bullet& bullet)
+  {
+    auto iter = Slots.find(bullet.ID);
+    if (iter != Slots.end())
+    {
+      Bullet& result = Items[iter->second] = bullet;
+      WriteHotFields(iter->second);
+      return result;
+    }
+
+    const size_t slot = Items.size();
+    Slots[bullet.ID] = slot;
+
+    Items.push_back(bullet);
+    Locations.push_back(bullet.Location);
+    Directions.push_back(bullet.Direction);
+    Speeds.push_back(bullet.Speed);
+    Times.push_back(bullet.Time);
+    CollisionTimes.push_back(GetCollisionTime(bullet));
+
+    return Items.back();
+  }
+
+  Bullet* Get(const Bullet::id_t& id)
+  {
+    auto iter = Slots.find(id);
+    return (iter == Slots.end()) ? nullptr : &Items[iter->second];
+  }
+
+  const Bullet* Get(const Bullet::id_t& id) const
+  {
+    auto iter = Slots.find(id);
+    return (iter == Slots.end()) ? nullptr : &Items[iter->second];
+  }
+
+  bool Remove(const Bullet::id_t& id)
+  {
+    auto iter = Slots.find(id);
+
+    if (iter == Slots.end()) return false;
+
+    const size_t slot = iter->second;
+    const size_t last = Items.size() - 1;
+
+    Slots.erase(iter);
+
+    if (slot != last)
+    {
+      Items[slot] = std::move(Items[last]);
+      Locations[slot] = Locations[last];
+      Directions[slot] = Directions[last];
+      Speeds[slot] = Speeds[last];
+      Times[slot] = Times[last];
+      CollisionTimes[slot] = CollisionTimes[last];
+      Slots[Items[slot].ID] = slot;
+    }
+
+    Items.pop_back();
+    Locations.pop_back();
+    Directions.pop_back();
+    Speeds.pop_back();
+    Times.pop_back();
+    CollisionTimes.pop_back();
+
+    return true;
+  }
+
+  // refreshes mirrored fields of a stored bullet
+  void Update(const Bullet& bullet)
+  {
+    if (Items.size() && &bullet >= &Items.front() && &bullet <= &Items.back())
+    {
+      WriteHotFields(&bullet - &Items.front());
+      return;
+    }
+
+    auto iter = Slots.find(bullet.ID);
+    if (iter != Slots.end())
+      WriteHotFields(iter->second);
+  }
+
+  size_t size() const
+  {
+    return Items.size();
+  }
+
+  void clear()
+  {
+    Slots.clear();
+    Items.clear();
+    Locations.clear();
+    Directions.clear();
+    Speeds.clear();
+    Times.clear();
+    CollisionTimes.clear();
+  }
+
+  Bullet& operator[](size_t slot)
+  {
+    return Items[slot];
+  }
+
+  const Bullet& operator[](size_t slot) const
+  {
+    return Items[slot];
+  }
+
+  auto begin() { return Items.begin(); }
+  auto end() { return Items.end(); }
+  auto begin() const { return Items.begin(); }
+  auto end() const { return Items.end(); }
+
+  // callback takes (Bullet&) or (Bullet&, size_t slot)
+  template<typename F>
+  void ForEach(F callback)
+  {
+    for (size_t slot = 0; slot < Items.size(); ++slot)
+    {
+      if constexpr (std::is_invocable_v<F, Bullet&, size_t>)
+        callback(Items[slot], slot);
+      else
+        callback(Items[slot]);
+    }
+  }
+
+  template<typename F>
+  void ForEach(F callback) const
+  {
+    for (size_t slot = 0; slot < Items.size(); ++slot)
+    {
+      if constexpr (std::is_invocable_v<F, const Bullet&, size_t>)
+        callback(Items[slot], slot);
+      else
+        callback(Items[slot]);
+    }
+  }
+
+  const Array<float2>& GetLocations() const { return Locations; }
+  const Array<float2>& GetDirections() const { return Directions; }
+  const Array<float>& GetSpeeds() const { return Speeds; }
+  const Array<tick_t>& GetTimes() const { return Times; }
+
+  // time of the next scheduled hit or infinity
+  const Array<tick_t>& GetCollisionTimes() const { return CollisionTimes; }
+
+private:
+
+  std::unordered_map<Bullet::id_t, size_t> Slots;
+
+  Array<Bullet> Items;
+
+  Array<float2> Locations;
+  Array<float2> Directions;
+  Array<float> Speeds;
+  Array<tick_t> Times;
+  Array<tick_t> CollisionTimes;
+
+  static inline tick_t GetCollisionTime(const Bullet& bullet)
+  {
+    return bullet.Collision.Hits
+      ? bullet.Collision.Time
+      : Ticks::Infinity;
+  }
+
+  inline void WriteHotFields(size_t slot)
+  {
+    const Bullet& bullet = Items[slot];
+    Locations[slot] = bullet.Location;
+    Directions[slot] = bullet.Direction;
+    Speeds[slot] = bullet.Speed;
+    Times[slot] = bullet.Time;
+    CollisionTimes[slot] = GetCollisionTime(bullet);
+  }
+
+};
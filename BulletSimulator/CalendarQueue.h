@@ -0,0 +1,367 @@
+#pragma once
+
+#include "Math.h"
+#include "Tick.h"
+#include "Array.h"
+
+#include <memory>
+#include <cstdint>
+#include <utility>
+#include <algorithm>
+
+
+// calendar queue of events ordered by (Time, ID), same interface as EventQueue.
+// time is split in days of Width mapped onto a ring of buckets, a bucket holds the events
+// of every day that falls on it sorted latest first. Pop walks the ring from the current day,
+// so with roughly uniform event times both ends are amortized O(1).
+// the ring is rebuilt with a width measured from the earliest events whenever the
+// number of events leaves [buckets / 2, buckets * 2]
+template<typename E>
+class CalendarQueue
+{
+public:
+
+  typedef std::shared_ptr<E> Pointer;
+
+  CalendarQueue()
+  {
+    Buckets.resize(MinBuckets);
+  }
+
+  size_t size() const
+  {
+    return Count - Cancelled;
+  }
+
+  void clear()
+  {
+    for (Array<Entry>& bucket : Buckets)
+    {
+      for (Entry& entry : bucket)
+        entry.Event->QueueTicket = 0;
+      bucket.clear();
+    }
+    Count = 0;
+    Cancelled = 0;
+    Current = Found = NotFound;
+  }
+
+  // an event can be queued once, pushing it again moves it
+  void Push(const Pointer& event)
+  {
+    Remove(event);
+
+    event->QueueTicket = ++LastTicket;
+
+    Insert({ event->Time, event->ID, event->QueueTicket, event });
+    ++Count;
+
+    if (Count > Buckets.size() * 2) Resize(Buckets.size() * 2);
+  }
+
+  // earliest event or nullptr, not const as it drops cancelled events on the way
+  const Pointer& Top()
+  {
+    static const Pointer empty;
+    const size_t bucket = FindTop();
+    return bucket == NotFound ? empty : Buckets[bucket].back().Event;
+  }
+
+  Pointer Pop()
+  {
+    const size_t bucket = FindTop();
+    if (bucket == NotFound) return Pointer();
+
+    Pointer event = std::move(Buckets[bucket].back().Event);
+    event->QueueTicket = 0;
+
+    Buckets[bucket].pop_back();
+    --Count;
+    Found = NotFound;
+
+    if (Buckets.size() > MinBuckets && Count * 2 < Buckets.size()) Resize(Buckets.size() / 2);
+
+    return event;
+  }
+
+  bool Contains(const Pointer& event) const
+  {
+    return event && event->QueueTicket != 0;
+  }
+
+  // O(1), returns false if the event isn't queued
+  bool Remove(const Pointer& event)
+  {
+    if (!Contains(event)) return false;
+
+    event->QueueTicket = 0;
+    ++Cancelled;
+    Found = NotFound;
+
+    DropCancelled();
+
+    return true;
+  }
+
+  // removes every queued event the predicate accepts
+  template<typename F>
+  void RemoveIf(F predicate)
+  {
+    for (Array<Entry>& bucket : Buckets)
+    {
+      for (Entry& entry : bucket)
+      {
+        if (!IsLive(entry) || !predicate(entry.Event)) continue;
+        entry.Event->QueueTicket = 0;
+        ++Cancelled;
+      }
+    }
+
+    Found = NotFound;
+
+    DropCancelled();
+  }
+
+  // removed events still taking up entries
+  size_t GetCancelledCount() const
+  {
+    return Cancelled;
+  }
+
+  // queued events in order, the first max_count of them at most. meant for debug views
+  Array<Pointer> GetSorted(size_t max_count = SIZE_MAX) const
+  {
+    Array<const Entry*> entries;
+    entries.reserve(size());
+    for (const Array<Entry>& bucket : Buckets)
+      for (const Entry& entry : bucket)
+        if (IsLive(entry)) entries.push_back(&entry);
+
+    const size_t count = std::min(max_count, entries.size());
+
+    std::partial_sort(entries.begin(), entries.begin() + count, entries.end(), [](const Entry* a, const Entry* b)
+    {
+      return Less(*a, *b);
+    });
+
+    Array<Pointer> result;
+    result.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+      result.push_back(entries[i]->Event);
+    return result;
+  }
+
+private:
+
+  static constexpr size_t MinBuckets = 16;
+
+  // earliest events the width is measured on
+  static constexpr size_t WidthSamples = 25;
+
+  static constexpr size_t NotFound = SIZE_MAX;
+
+  struct Entry
+  {
+    tick_t Time;
+    uint64_t ID;
+    uint64_t Ticket;
+    Pointer Event;
+  };
+
+  Array<Array<Entry>> Buckets;
+
+  tick_t Width = Ticks::PerSecond / 64;
+
+  // bucket and day the search starts from, no live event is earlier than that day
+  size_t Current = NotFound;
+  tick_t CurrentDay = 0;
+
+  // bucket holding the earliest event, valid until the queue changes
+  size_t Found = NotFound;
+
+  // entries including the cancelled ones
+  size_t Count = 0;
+
+  size_t Cancelled = 0;
+
+  uint64_t LastTicket = 0;
+
+  static inline bool Less(const Entry& a, const Entry& b)
+  {
+    return (a.Time == b.Time) ? a.ID < b.ID : a.Time < b.Time;
+  }
+
+  static inline bool IsLive(const Entry& entry)
+  {
+    return entry.Ticket == entry.Event->QueueTicket;
+  }
+
+  static inline bool IsFinite(tick_t time)
+  {
+    return time != Ticks::Infinity && time != -Ticks::Infinity;
+  }
+
+  // rounds down for negative times too
+  tick_t GetDay(tick_t time) const
+  {
+    return time >= 0 ? time / Width : -((-time - 1) / Width) - 1;
+  }
+
+  // times that don't fall on a day go to the first bucket and are found by the full search
+  size_t GetBucket(tick_t time) const
+  {
+    if (!IsFinite(time)) return 0;
+    const tick_t bucket = GetDay(time) % tick_t(Buckets.size());
+    return size_t(bucket < 0 ? bucket + tick_t(Buckets.size()) : bucket);
+  }
+
+  void Insert(Entry&& entry)
+  {
+    Array<Entry>& bucket = Buckets[GetBucket(entry.Time)];
+
+    // latest first, the earliest is popped from the back
+    auto position = std::upper_bound(bucket.begin(), bucket.end(), entry, [](const Entry& a, const Entry& b)
+    {
+      return Less(b, a);
+    });
+
+    if (Current != NotFound && (!IsFinite(entry.Time) || GetDay(entry.Time) < CurrentDay))
+      Current = NotFound;
+
+    if (Found != NotFound && Less(entry, Buckets[Found].back()))
+      Found = NotFound;
+
+    bucket.insert(position, std::move(entry));
+  }
+
+  // cancelled entries on top of a bucket are dropped on the way
+  void PopCancelled(Array<Entry>& bucket)
+  {
+    while (bucket.size() && !IsLive(bucket.back()))
+    {
+      bucket.pop_back();
+      --Count;
+      --Cancelled;
+    }
+  }
+
+  size_t FindTop()
+  {
+    if (Found != NotFound) return Found;
+
+    if (size() == 0) return NotFound;
+
+    const size_t bucket_count = Buckets.size();
+
+    // a year from the current day, days compared the way they were bucketed.
+    // events beyond it are left to the full search
+    if (Current != NotFound)
+    {
+      size_t bucket = Current;
+      tick_t day = CurrentDay;
+
+      for (size_t i = 0; i < bucket_count; ++i)
+      {
+        Array<Entry>& entries = Buckets[bucket];
+        PopCancelled(entries);
+
+        if (entries.size() && IsFinite(entries.back().Time) && GetDay(entries.back().Time) <= day)
+        {
+          Current = Found = bucket;
+          CurrentDay = day;
+          return Found;
+        }
+
+        bucket = (bucket + 1) % bucket_count;
+        day += 1;
+      }
+    }
+
+    size_t earliest = NotFound;
+    for (size_t bucket = 0; bucket < bucket_count; ++bucket)
+    {
+      Array<Entry>& entries = Buckets[bucket];
+      PopCancelled(entries);
+
+      if (entries.size() && (earliest == NotFound || Less(entries.back(), Buckets[earliest].back())))
+        earliest = bucket;
+    }
+
+    Found = earliest;
+
+    if (earliest != NotFound)
+    {
+      const tick_t time = Buckets[earliest].back().Time;
+      Current = IsFinite(time) ? earliest : NotFound;
+      CurrentDay = IsFinite(time) ? GetDay(time) : 0;
+    }
+
+    return Found;
+  }
+
+  // average gap between the earliest events, a day then holds a few of them
+  tick_t MeasureWidth(Array<Entry>& entries) const
+  {
+    const size_t samples = std::min(WidthSamples, entries.size());
+
+    std::partial_sort(entries.begin(), entries.begin() + samples, entries.end(), Less);
+
+    // gaps are summed as doubles, far apart finite times would overflow ticks
+    size_t gaps = 0;
+    double total = 0;
+    for (size_t i = 1; i < samples; ++i)
+    {
+      if (!IsFinite(entries[i - 1].Time) || !IsFinite(entries[i].Time)) break;
+      total += double(entries[i].Time) - double(entries[i - 1].Time);
+      ++gaps;
+    }
+
+    if (!gaps || total <= 0) return Width;
+
+    // gaps far above the average are outliers, left out of the second pass
+    const double average = total / gaps;
+
+    size_t kept = 0;
+    double kept_total = 0;
+    for (size_t i = 1; i < gaps + 1; ++i)
+    {
+      const double gap = double(entries[i].Time) - double(entries[i - 1].Time);
+      if (gap > average * 2) continue;
+      kept_total += gap;
+      ++kept;
+    }
+
+    const double width = (kept && kept_total > 0) ? 3.0 * kept_total / kept : 3.0 * average;
+
+    return Max(tick_t(1), tick_t(Min(width, double(Ticks::Infinity / 2))));
+  }
+
+  void Resize(size_t bucket_count)
+  {
+    Array<Entry> entries;
+    entries.reserve(size());
+    for (Array<Entry>& bucket : Buckets)
+    {
+      for (Entry& entry : bucket)
+        if (IsLive(entry)) entries.push_back(std::move(entry));
+      bucket.clear();
+    }
+
+    Width = MeasureWidth(entries);
+
+    Buckets.resize(bucket_count);
+    Count = entries.size();
+    Cancelled = 0;
+    Current = Found = NotFound;
+
+    for (Entry& entry : entries)
+      Insert(std::move(entry));
+  }
+
+  // keeps the buckets at most half cancelled
+  void DropCancelled()
+  {
+    if (Cancelled > 64 && Cancelled * 2 > Count)
+      Resize(Buckets.size());
+  }
+};
@@ -3,6 +3,9 @@
 #include <functional>
 
 
+template<typename T, class Cmp = std::less<T>>
+class Set;
+
 template<class Base, typename T>
 class Collection : public Base
 {
@@ -58,7 +61,7 @@ public:
   {
     for (const auto& value : other)
     {
-      if (!this->size()) return;
+      if (!this->size()) break;
       Remove(value);
     }
     return *this;
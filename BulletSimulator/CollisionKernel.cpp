@@ -0,0 +1,240 @@
+#include "Common.h"
+
+#include "CollisionKernel.h"
+
+#include "Config.h"
+#include "Math2D.h"
+
+#include <cmath>
+#include <limits>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define COLLISION_KERNEL_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define COLLISION_KERNEL_AVX2 __attribute__((target("avx2")))
+#else
+#define COLLISION_KERNEL_AVX2
+#endif
+
+
+namespace
+{
+  const float Infinity = std::numeric_limits<float>::infinity();
+
+  void IntersectScalar(const CollisionKernel::Batch& batch, float radius, float range, CollisionKernel::Result& result)
+  {
+    for (size_t i = 0; i < CollisionKernel::Width; ++i)
+    {
+      result.Distance[i] = Infinity;
+      if (i >= batch.Count) continue;
+
+      float2 point, normal;
+
+      result.Distance[i] = Math2D::RayCapsuleIntersection(
+        { { batch.AX[i], batch.AY[i] }, { batch.BX[i], batch.BY[i] } },
+        { batch.OriginX[i], batch.OriginY[i] },
+        { batch.DirectionX[i], batch.DirectionY[i] },
+        radius, range, point, normal);
+
+      result.PointX[i] = point.x;
+      result.PointY[i] = point.y;
+      result.NormalX[i] = normal.x;
+      result.NormalY[i] = normal.y;
+    }
+  }
+
+#ifdef COLLISION_KERNEL_X86
+
+  // mirrors Math2D::RayCapsuleIntersection operation for operation
+  COLLISION_KERNEL_AVX2
+  void IntersectAVX2(const CollisionKernel::Batch& batch, float radius, float range, CollisionKernel::Result& result)
+  {
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 sign_mask = _mm256_set1_ps(-0.0f);
+    const __m256 infinity = _mm256_set1_ps(Infinity);
+    const __m256 r = _mm256_set1_ps(radius);
+    const __m256 r_sq = _mm256_mul_ps(r, r);
+
+    const __m256 ox = _mm256_load_ps(batch.OriginX);
+    const __m256 oy = _mm256_load_ps(batch.OriginY);
+    const __m256 dx = _mm256_load_ps(batch.DirectionX);
+    const __m256 dy = _mm256_load_ps(batch.DirectionY);
+    const __m256 ax = _mm256_load_ps(batch.AX);
+    const __m256 ay = _mm256_load_ps(batch.AY);
+    const __m256 bx = _mm256_load_ps(batch.BX);
+    const __m256 by = _mm256_load_ps(batch.BY);
+
+    const __m256 ex = _mm256_sub_ps(bx, ax);
+    const __m256 ey = _mm256_sub_ps(by, ay);
+    const __m256 length_sq = _mm256_add_ps(_mm256_mul_ps(ex, ex), _mm256_mul_ps(ey, ey));
+    const __m256 length = _mm256_sqrt_ps(length_sq);
+    const __m256 inv_length = _mm256_blendv_ps(zero, _mm256_div_ps(one, length),
+      _mm256_cmp_ps(length, zero, _CMP_GT_OQ));
+
+    const __m256 sx = _mm256_mul_ps(_mm256_xor_ps(ey, sign_mask), inv_length);
+    const __m256 sy = _mm256_mul_ps(ex, inv_length);
+
+    const __m256 rx = _mm256_sub_ps(ox, ax);
+    const __m256 ry = _mm256_sub_ps(oy, ay);
+
+    const __m256 distance = _mm256_add_ps(_mm256_mul_ps(sx, rx), _mm256_mul_ps(sy, ry));
+    const __m256 velocity = _mm256_add_ps(_mm256_mul_ps(sx, dx), _mm256_mul_ps(sy, dy));
+
+    const __m256 side = _mm256_blendv_ps(_mm256_xor_ps(velocity, sign_mask), distance,
+      _mm256_cmp_ps(distance, zero, _CMP_NEQ_UQ));
+
+    const __m256 abs_distance = _mm256_andnot_ps(sign_mask, distance);
+    const __m256 abs_velocity = _mm256_andnot_ps(sign_mask, velocity);
+
+    const __m256 inside = _mm256_cmp_ps(abs_distance, r, _CMP_LE_OQ);
+    const __m256 approaching = _mm256_cmp_ps(_mm256_mul_ps(side, velocity), zero, _CMP_LT_OQ);
+
+    const __m256 enter = _mm256_blendv_ps(
+      _mm256_div_ps(_mm256_sub_ps(abs_distance, r), abs_velocity), zero, inside);
+
+    const __m256 cx = _mm256_add_ps(ox, _mm256_mul_ps(dx, enter));
+    const __m256 cy = _mm256_add_ps(oy, _mm256_mul_ps(dy, enter));
+
+    const __m256 projection = _mm256_add_ps(
+      _mm256_mul_ps(_mm256_sub_ps(cx, ax), ex),
+      _mm256_mul_ps(_mm256_sub_ps(cy, ay), ey));
+
+    const __m256 face = _mm256_and_ps(
+      _mm256_and_ps(_mm256_cmp_ps(projection, zero, _CMP_GE_OQ), _mm256_cmp_ps(projection, length_sq, _CMP_LE_OQ)),
+      _mm256_cmp_ps(length_sq, zero, _CMP_GT_OQ));
+
+    const __m256 flip = _mm256_cmp_ps(side, zero, _CMP_LT_OQ);
+    const __m256 face_nx = _mm256_blendv_ps(sx, _mm256_xor_ps(sx, sign_mask), flip);
+    const __m256 face_ny = _mm256_blendv_ps(sy, _mm256_xor_ps(sy, sign_mask), flip);
+
+    // cap lanes
+    const __m256 before_a = _mm256_cmp_ps(projection, zero, _CMP_LT_OQ);
+    const __m256 cap_x = _mm256_blendv_ps(bx, ax, before_a);
+    const __m256 cap_y = _mm256_blendv_ps(by, ay, before_a);
+
+    const __m256 mx = _mm256_sub_ps(ox, cap_x);
+    const __m256 my = _mm256_sub_ps(oy, cap_y);
+    const __m256 b = _mm256_add_ps(_mm256_mul_ps(mx, dx), _mm256_mul_ps(my, dy));
+    const __m256 c = _mm256_sub_ps(_mm256_add_ps(_mm256_mul_ps(mx, mx), _mm256_mul_ps(my, my)), r_sq);
+    const __m256 discriminant = _mm256_sub_ps(_mm256_mul_ps(b, b), c);
+
+    const __m256 cap_inside = _mm256_cmp_ps(c, zero, _CMP_LE_OQ);
+    const __m256 cap_t = _mm256_blendv_ps(
+      _mm256_sub_ps(_mm256_xor_ps(b, sign_mask), _mm256_sqrt_ps(discriminant)), zero, cap_inside);
+
+    const __m256 cap_hit = _mm256_and_ps(
+      _mm256_cmp_ps(b, zero, _CMP_LT_OQ),
+      _mm256_or_ps(cap_inside, _mm256_cmp_ps(discriminant, zero, _CMP_GE_OQ)));
+
+    const __m256 hx = _mm256_sub_ps(_mm256_add_ps(ox, _mm256_mul_ps(dx, cap_t)), cap_x);
+    const __m256 hy = _mm256_sub_ps(_mm256_add_ps(oy, _mm256_mul_ps(dy, cap_t)), cap_y);
+    const __m256 hit_length = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(hx, hx), _mm256_mul_ps(hy, hy)));
+    const __m256 inv_hit_length = _mm256_blendv_ps(
+      _mm256_div_ps(one, r),
+      _mm256_blendv_ps(zero, _mm256_div_ps(one, hit_length), _mm256_cmp_ps(hit_length, zero, _CMP_GT_OQ)),
+      cap_inside);
+
+    // merge
+    const __m256 t = _mm256_blendv_ps(cap_t, enter, face);
+    const __m256 nx = _mm256_blendv_ps(_mm256_mul_ps(hx, inv_hit_length), face_nx, face);
+    const __m256 ny = _mm256_blendv_ps(_mm256_mul_ps(hy, inv_hit_length), face_ny, face);
+
+    __m256 hit = _mm256_or_ps(inside, approaching);
+    hit = _mm256_and_ps(hit, _mm256_blendv_ps(cap_hit, approaching, face));
+    hit = _mm256_and_ps(hit, _mm256_cmp_ps(t, _mm256_set1_ps(range), _CMP_LE_OQ));
+
+    alignas(32) static const int lanes[CollisionKernel::Width] = { 0, 1, 2, 3, 4, 5, 6, 7 };
+    hit = _mm256_and_ps(hit, _mm256_castsi256_ps(_mm256_cmpgt_epi32(
+      _mm256_set1_epi32(int(batch.Count)), _mm256_load_si256(reinterpret_cast<const __m256i*>(lanes)))));
+
+    _mm256_store_ps(result.Distance, _mm256_blendv_ps(infinity, t, hit));
+    _mm256_store_ps(result.PointX, _mm256_add_ps(ox, _mm256_mul_ps(dx, t)));
+    _mm256_store_ps(result.PointY, _mm256_add_ps(oy, _mm256_mul_ps(dy, t)));
+    _mm256_store_ps(result.NormalX, nx);
+    _mm256_store_ps(result.NormalY, ny);
+  }
+
+  bool DetectAVX2()
+  {
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+
+    __cpuid(info, 1);
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx) return false;
+
+    // OS saves ymm registers
+    if ((_xgetbv(0) & 6) != 6) return false;
+
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+  }
+
+  const bool HasAVX2 = DetectAVX2();
+
+#else
+
+  const bool HasAVX2 = false;
+
+#endif
+}
+
+CollisionKernel::Batch::Batch()
+{
+  for (size_t i = 0; i < Width; ++i)
+  {
+    OriginX[i] = OriginY[i] = 0;
+    DirectionX[i] = DirectionY[i] = 0;
+    AX[i] = AY[i] = BX[i] = BY[i] = 0;
+  }
+}
+
+size_t CollisionKernel::Batch::Add(const float2& origin, const float2& direction, const LineSegment& segment)
+{
+  const size_t lane = Count++;
+  OriginX[lane] = origin.x;
+  OriginY[lane] = origin.y;
+  DirectionX[lane] = direction.x;
+  DirectionY[lane] = direction.y;
+  AX[lane] = segment.A.x;
+  AY[lane] = segment.A.y;
+  BX[lane] = segment.B.x;
+  BY[lane] = segment.B.y;
+  return lane;
+}
+
+bool CollisionKernel::Result::Hits(size_t lane) const
+{
+  return Distance[lane] != Infinity;
+}
+
+void CollisionKernel::Intersect(const Batch& batch, float radius, float range, Result& result)
+{
+#ifdef COLLISION_KERNEL_X86
+  if (IsVectorized())
+  {
+    IntersectAVX2(batch, radius, range, result);
+    return;
+  }
+#endif
+  IntersectScalar(batch, radius, range, result);
+}
+
+bool CollisionKernel::IsVectorized()
+{
+  return HasAVX2 && Config::EnableVectorizedCollisions;
+}
@@ -13,6 +13,12 @@ size_t Config::HistoryMaxBytes = 100 * 1024 * 1024;
 
 double Config::HistoryMaxAge = 30.0;
 
+double Config::KeyframeEventRatio = 1.0;
+
+size_t Config::HistorySpillBytes = 0;
+
+std::string Config::HistorySpillPath = "history.spill";
+
 size_t Config::TextCacheMaxPixels = size_t(9.99 * 1024 * 1024 / 4);
 
 double Config::BulletSpeed = 500.0;
@@ -25,6 +31,22 @@ uint32_t Config::LastBulletId = 0;
 
 double Config::BulletRadius = 3;
 
+double Config::CollisionGridCellSize = 64.0;
+
+double Config::CollisionHorizon = 512.0;
+
+double Config::WorldBounds = 5000.0;
+
+double Config::BulletLifetime = 0.0;
+
+bool Config::EnableVectorizedCollisions = true;
+
+bool Config::EnableCellTraversal = false;
+
+bool Config::UseCalendarQueue = false;
+
+size_t Config::ParallelCollisionBatchSize = 64;
+
 double Config::DebugValue1 = 0.0;
 
 double Config::DebugValue2 = 0.0;
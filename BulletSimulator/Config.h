@@ -18,6 +18,14 @@ public:
   
   static double HistoryMaxAge; // default: 10.0
 
+  // a keyframe is taken once more events were logged than bullets and walls times this
+  static double KeyframeEventRatio; // default: 1.0
+
+  // size of the file events aged out of memory are kept in, 0 to drop them
+  static size_t HistorySpillBytes; // default: 0
+
+  static std::string HistorySpillPath; // default: "history.spill"
+
   static size_t TextCacheMaxPixels; // default: 100000
 
   static double BulletSpeed; // default: 1000.0
@@ -30,6 +38,25 @@ public:
 
   static double BulletRadius; // default: 0.01
 
+  static double CollisionGridCellSize; // default: 64.0
+
+  // distance a collision search looks ahead, 0 for Bullet::Range
+  static double CollisionHorizon; // default: 512.0
+
+  static double WorldBounds; // default: 5000.0
+
+  static double BulletLifetime; // default: 0.0
+
+  static bool EnableVectorizedCollisions; // default: true
+
+  // bullets search only the grid cell they are in and move between cells with CellCrossing events
+  static bool EnableCellTraversal; // default: false
+
+  // future events in a calendar queue instead of a heap, faster with many events close together
+  static bool UseCalendarQueue; // default: false
+
+  static size_t ParallelCollisionBatchSize; // default: 64
+
   static double DebugValue1; // default: 0.0
 
   static double DebugValue2; // default: 0.0
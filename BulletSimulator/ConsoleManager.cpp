@@ -31,7 +31,11 @@ std::string GetTimeString(std::chrono::system_clock::time_point time = std::chro
 {
   time_t tt = std::chrono::system_clock::to_time_t(time);
   char buf[256];
+#ifdef _MSC_VER
   ctime_s(buf, 256, &tt);
+#else
+  ctime_r(&tt, buf);
+#endif
   return std::string(buf);
 }
 
@@ -99,6 +103,24 @@ Map<std::string, Ops>& GetConfigOps()
     } };
   };
 
+  // shown and set in seconds
+  static const auto config_var_ticks = [](const std::string& name, tick_t& value)
+  {
+    config_ops[name] = { [&value]()
+    {
+      return std::to_string(Ticks::ToSeconds(value));
+    }, [&value](const std::string new_value) {
+      try
+      {
+        value = Ticks::FromSeconds(std::stod(new_value));
+      }
+      catch (std::exception&)
+      {
+        LOG_ERROR << "invalid value: " << new_value << " expected: seconds";
+      }
+    } };
+  };
+
   static const auto config_var_bool = [](const std::string& name, bool& value)
   {
     config_ops[name] = { [&value]()
@@ -122,16 +144,24 @@ Map<std::string, Ops>& GetConfigOps()
   config_var_bool("ShowViewLine", Config::ShowViewLine);
   config_var_bool("ShowViewCollisions", Config::ShowViewCollisions);
   config_var_bool("EnableParallelTextureGeneration", Config::EnableParallelTextureGeneration);  
+  config_var_bool("EnableVectorizedCollisions", Config::EnableVectorizedCollisions);
+  config_var_bool("UseCalendarQueue", Config::UseCalendarQueue);
+  config_var_bool("EnableCellTraversal", Config::EnableCellTraversal);
   config_var_bool("ShowMouseLocation", Config::ShowMouseLocation);
   config_var_bool("LogCollisions", Config::LogCollisions);
   config_var_bool("LogNetwork", Config::LogNetwork);
   
-  config_var_double("Time", World::Get().CurrentTime);
+  config_var_ticks("Time", World::Get().CurrentTick);
   config_var_double("TimeSpeedScale", Config::TimeSpeedScale);
   config_var_double("BulletSpeed", Config::BulletSpeed);
   config_var_double("HistoryMaxAge", Config::HistoryMaxAge);
+  config_var_double("KeyframeEventRatio", Config::KeyframeEventRatio);
   config_var_double("FireRate", Config::FireRate);
   config_var_double("BulletRadius", Config::BulletRadius);
+  config_var_double("CollisionGridCellSize", Config::CollisionGridCellSize);
+  config_var_double("CollisionHorizon", Config::CollisionHorizon);
+  config_var_double("WorldBounds", Config::WorldBounds);
+  config_var_double("BulletLifetime", Config::BulletLifetime);
   config_var_double("BaseLineWidth", Config::BaseLineWidth);
   config_var_double("CameraInterpolationSpeed", Config::CameraInterpolationSpeed);  
   config_var_double("Acceleration", Config::Acceleration);
@@ -145,8 +175,10 @@ Map<std::string, Ops>& GetConfigOps()
   config_var_float("TargetFPS", Config::TargetFPS);
 
   config_var_size_t("HistoryMaxBytes", Config::HistoryMaxBytes);
+  config_var_size_t("HistorySpillBytes", Config::HistorySpillBytes);
   config_var_size_t("TextCacheMaxPixels", Config::TextCacheMaxPixels);    
   config_var_size_t("MaxPreciseBullets", Config::MaxPreciseBullets);
+  config_var_size_t("ParallelCollisionBatchSize", Config::ParallelCollisionBatchSize);
   
   return config_ops;
 }
@@ -195,7 +227,7 @@ Map<std::string, std::function<void(const std::vector<std::string>& args)>>& Con
   Commands["time"] = [this](const std::vector<std::string>& args)
   {
     MessageStream(*this) << "current time: " << GetTimeString();
-    MessageStream(*this) << "seconds since start: " << World::Get().CurrentTime;
+    MessageStream(*this) << "seconds since start: " << World::Get().GetSeconds();
   };
 
   Commands["fullscreen"] = [this](const std::vector<std::string>& args)
@@ -264,6 +296,59 @@ Map<std::string, std::function<void(const std::vector<std::string>& args)>>& Con
     MessageStream(*this) << args[0] << " = " << args[1];
   };
 
+  Commands["history"] = [this](const std::vector<std::string>& args)
+  {
+    const ::EventsHistory& history = World::Get().History;
+
+    // history bullet|wall <id> lists the logged events of one entity
+    if (args.size())
+    {
+      if (args.size() != 2 || (args[0] != "bullet" && args[0] != "wall") || !String::IsNumber(args[1]))
+      {
+        LOG_ERROR << "usage: history [bullet|wall <id>]";
+        return;
+      }
+
+      const uint32_t id = uint32_t(std::stoul(args[1]));
+
+      const ::EventsHistory::EventsLogSet* events = (args[0] == "bullet")
+        ? history.GetBulletEvents(id)
+        : history.GetWallEvents(id);
+
+      const size_t count = events ? events->size() : 0;
+
+      MessageStream(*this) << args[0] << "[" << id << "]: " << count << " logged events";
+
+      if (!events) return;
+
+      const size_t max_count = 32;
+      size_t index = 0;
+      for (const auto& event : *events)
+      {
+        if (index++ == max_count)
+        {
+          MessageStream(*this) << "  ... " << count - max_count << " older";
+          break;
+        }
+        MessageStream(*this) << "  " << ::EventsHistory::GetTagName(event->Tag) << " at " << Ticks::ToSeconds(event->Time);
+      }
+      return;
+    }
+
+    MessageStream(*this) << "past events: " << history.EventsLog.size()
+      << ", " << String::FormatBytes(history.GetLogSize()) << " of " << String::FormatBytes(Config::HistoryMaxBytes);
+    MessageStream(*this) << "future events: " << history.EventsQueue.size()
+      << ", stale: " << history.EventsQueue.GetCancelledCount() << " queued, " << history.StaleCollisionEvents << " popped";
+    MessageStream(*this) << "event pools: " << String::FormatBytes(history.GetTotalSize());
+    if (history.Spill.IsOpen())
+    {
+      MessageStream(*this) << "spilled events: " << history.Spill.size()
+        << ", " << String::FormatBytes(history.Spill.GetUsedBytes()) << " of " << String::FormatBytes(history.Spill.GetCapacity());
+    }
+    MessageStream(*this) << "rewind horizon: " << Ticks::ToSeconds(history.GetRewindHorizon())
+      << " (" << Ticks::ToSeconds(World::Get().CurrentTick - history.GetRewindHorizon()) << "s back)";
+  };
+
   Commands["reset"] = [this](const std::vector<std::string>& args)
   {
     World::Reset();
@@ -321,14 +406,17 @@ Map<std::string, std::function<void(const std::vector<std::string>& args)>>& Con
   {
     World::Reset();
 
-    Wall wall1 = { ++Config::LastWallId, { { 0, 0 }, { -100, 100 } }, 1.0f };
-    World::Get().History.ScheduleEvent<EventsHistory::Add<Wall>>(1.0, wall1);
-    Wall wall2 = { ++Config::LastWallId, { { 0, 0 }, { 100, 100 } }, 1.0f };
-    World::Get().History.ScheduleEvent<EventsHistory::Add<Wall>>(1.0, wall2);
+    const tick_t wall_time = Ticks::FromSeconds(1.0);
+    const tick_t bullet_time = Ticks::FromSeconds(1.25);
+
+    Wall wall1 = { ++Config::LastWallId, { { 0, 0 }, { -100, 100 } }, wall_time };
+    World::Get().History.ScheduleEvent<EventsHistory::Add<Wall>>(wall_time, wall1);
+    Wall wall2 = { ++Config::LastWallId, { { 0, 0 }, { 100, 100 } }, wall_time };
+    World::Get().History.ScheduleEvent<EventsHistory::Add<Wall>>(wall_time, wall2);
 
-    Bullet bullet(++Config::LastBulletId, float2(0, 200), float2(0, -1), 100.0f, 1.25, 1e9);
-    World::Get().GetManager<BulletManager>()->UpdateBulletCollision(bullet, 1.25);
-    World::Get().History.ScheduleEvent<EventsHistory::Add<Bullet>>(1.25, bullet);
+    Bullet bullet(++Config::LastBulletId, float2(0, 200), float2(0, -1), 100.0f, bullet_time, 1e9);
+    World::Get().GetManager<BulletManager>()->UpdateBulletCollision(bullet, bullet_time);
+    World::Get().History.ScheduleEvent<EventsHistory::Add<Bullet>>(bullet_time, bullet);
     
     Config::TimeSpeedScale = 1.0;
   };
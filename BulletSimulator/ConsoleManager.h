@@ -20,7 +20,7 @@
 #define DEFAULT_COLOR { 0x0, 0xFF, 0xFF, 0xFF }
 #define DEFAULT_MAX_AGE 5.0
 
-class ConsoleManager: public Manager
+class ConsoleManager: public Manager, public MessageSink
 {
 public:
 
@@ -41,9 +41,14 @@ public:
 
   void AddMessage(const std::string& message, const Color& color = DEFAULT_COLOR, double max_age = DEFAULT_MAX_AGE);
 
+  void WriteMessage(const std::string& message, const LogColor& color, double max_age) override
+  {
+    AddMessage(message, Color(color.r, color.g, color.b, color.a), max_age);
+  }
+
   MessageStream GetStream(const Color& color = DEFAULT_COLOR, double max_age = DEFAULT_MAX_AGE)
   {
-    return MessageStream(*this, color, max_age);
+    return MessageStream(*this, LogColor(color.r, color.g, color.b, color.a), max_age);
   }
 
   void Render(SDL_Renderer* renderer);
@@ -0,0 +1,234 @@
+#pragma once
+
+#include "Tick.h"
+#include "Array.h"
+
+#include <memory>
+#include <cstdint>
+#include <utility>
+#include <algorithm>
+
+
+// 4-ary min heap of events ordered by (Time, ID).
+// entries keep the sort key next to the pointer so sifting doesn't touch the events,
+// E must have Time, ID and a QueueTicket the queue uses to recognise its live entry.
+// Remove only invalidates the entry, it is dropped when it reaches the top
+// or when cancelled entries outnumber live ones
+template<typename E>
+class EventQueue
+{
+public:
+
+  typedef std::shared_ptr<E> Pointer;
+
+  size_t size() const
+  {
+    return Entries.size() - Cancelled;
+  }
+
+  void clear()
+  {
+    for (Entry& entry : Entries)
+      entry.Event->QueueTicket = 0;
+    Entries.clear();
+    Cancelled = 0;
+  }
+
+  // an event can be queued once, pushing it again moves it
+  void Push(const Pointer& event)
+  {
+    Remove(event);
+
+    event->QueueTicket = ++LastTicket;
+
+    Entries.push_back({ event->Time, event->ID, event->QueueTicket, event });
+    SiftUp(Entries.size() - 1);
+  }
+
+  // earliest event or nullptr
+  const Pointer& Top() const
+  {
+    static const Pointer empty;
+    return Entries.size() ? Entries.front().Event : empty;
+  }
+
+  Pointer Pop()
+  {
+    if (!Entries.size()) return Pointer();
+
+    Pointer event = std::move(Entries.front().Event);
+    event->QueueTicket = 0;
+
+    RemoveTop();
+    DropCancelled();
+
+    return event;
+  }
+
+  // removed events still taking up entries
+  size_t GetCancelledCount() const
+  {
+    return Cancelled;
+  }
+
+  bool Contains(const Pointer& event) const
+  {
+    return event && event->QueueTicket != 0;
+  }
+
+  // O(1), returns false if the event isn't queued
+  bool Remove(const Pointer& event)
+  {
+    if (!Contains(event)) return false;
+
+    event->QueueTicket = 0;
+    ++Cancelled;
+
+    DropCancelled();
+
+    return true;
+  }
+
+  // removes every queued event the predicate accepts
+  template<typename F>
+  void RemoveIf(F predicate)
+  {
+    for (Entry& entry : Entries)
+    {
+      if (!IsLive(entry) || !predicate(entry.Event)) continue;
+      entry.Event->QueueTicket = 0;
+      ++Cancelled;
+    }
+
+    DropCancelled();
+  }
+
+  // queued events in order, the first max_count of them at most. meant for debug views
+  Array<Pointer> GetSorted(size_t max_count = SIZE_MAX) const
+  {
+    Array<const Entry*> entries;
+    entries.reserve(size());
+    for (const Entry& entry : Entries)
+      if (IsLive(entry)) entries.push_back(&entry);
+
+    const size_t count = std::min(max_count, entries.size());
+
+    std::partial_sort(entries.begin(), entries.begin() + count, entries.end(), [](const Entry* a, const Entry* b)
+    {
+      return Less(*a, *b);
+    });
+
+    Array<Pointer> result;
+    result.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+      result.push_back(entries[i]->Event);
+    return result;
+  }
+
+private:
+
+  static constexpr size_t Arity = 4;
+
+  struct Entry
+  {
+    tick_t Time;
+    uint64_t ID;
+    uint64_t Ticket;
+    Pointer Event;
+  };
+
+  Array<Entry> Entries;
+
+  size_t Cancelled = 0;
+
+  uint64_t LastTicket = 0;
+
+  static inline bool Less(const Entry& a, const Entry& b)
+  {
+    return (a.Time == b.Time) ? a.ID < b.ID : a.Time < b.Time;
+  }
+
+  static inline bool IsLive(const Entry& entry)
+  {
+    return entry.Ticket == entry.Event->QueueTicket;
+  }
+
+  void SiftUp(size_t index)
+  {
+    Entry entry = std::move(Entries[index]);
+
+    while (index > 0)
+    {
+      const size_t parent = (index - 1) / Arity;
+      if (!Less(entry, Entries[parent])) break;
+      Entries[index] = std::move(Entries[parent]);
+      index = parent;
+    }
+
+    Entries[index] = std::move(entry);
+  }
+
+  void SiftDown(size_t index)
+  {
+    Entry entry = std::move(Entries[index]);
+
+    const size_t count = Entries.size();
+
+    while (true)
+    {
+      const size_t first = index * Arity + 1;
+      if (first >= count) break;
+
+      const size_t last = std::min(first + Arity, count);
+
+      size_t min_child = first;
+      for (size_t child = first + 1; child < last; ++child)
+        if (Less(Entries[child], Entries[min_child])) min_child = child;
+
+      if (!Less(Entries[min_child], entry)) break;
+
+      Entries[index] = std::move(Entries[min_child]);
+      index = min_child;
+    }
+
+    Entries[index] = std::move(entry);
+  }
+
+  void RemoveTop()
+  {
+    if (Entries.size() > 1)
+    {
+      Entries.front() = std::move(Entries.back());
+      Entries.pop_back();
+      SiftDown(0);
+    }
+    else
+    {
+      Entries.pop_back();
+    }
+  }
+
+  // keeps the top live and the heap at most half cancelled
+  void DropCancelled()
+  {
+    if (Cancelled > 64 && Cancelled * 2 > Entries.size())
+    {
+      Entries.erase(std::remove_if(Entries.begin(), Entries.end(), [](const Entry& entry)
+      {
+        return !IsLive(entry);
+      }), Entries.end());
+
+      Cancelled = 0;
+
+      for (size_t i = Entries.size() / Arity + 1; i-- > 0;)
+        if (i < Entries.size()) SiftDown(i);
+    }
+
+    while (Entries.size() && !IsLive(Entries.front()))
+    {
+      RemoveTop();
+      --Cancelled;
+    }
+  }
+
+};
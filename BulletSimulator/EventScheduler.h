@@ -0,0 +1,94 @@
+#pragma once
+
+#include "EventQueue.h"
+#include "CalendarQueue.h"
+
+
+// queue of future events backed by a heap or a calendar queue, see Config::UseCalendarQueue.
+// switching moves the queued events over, both order them by (Time, ID)
+template<typename E>
+class EventScheduler
+{
+public:
+
+  typedef std::shared_ptr<E> Pointer;
+
+  bool IsCalendar() const
+  {
+    return Calendar;
+  }
+
+  void SetCalendar(bool calendar)
+  {
+    if (calendar == Calendar) return;
+
+    const Array<Pointer> events = Calendar ? CalendarEvents.GetSorted() : HeapEvents.GetSorted();
+
+    clear();
+    Calendar = calendar;
+
+    for (const Pointer& event : events)
+      Push(event);
+  }
+
+  size_t size() const
+  {
+    return Calendar ? CalendarEvents.size() : HeapEvents.size();
+  }
+
+  void clear()
+  {
+    if (Calendar) CalendarEvents.clear();
+    else HeapEvents.clear();
+  }
+
+  void Push(const Pointer& event)
+  {
+    if (Calendar) CalendarEvents.Push(event);
+    else HeapEvents.Push(event);
+  }
+
+  const Pointer& Top()
+  {
+    return Calendar ? CalendarEvents.Top() : HeapEvents.Top();
+  }
+
+  Pointer Pop()
+  {
+    return Calendar ? CalendarEvents.Pop() : HeapEvents.Pop();
+  }
+
+  bool Contains(const Pointer& event) const
+  {
+    return Calendar ? CalendarEvents.Contains(event) : HeapEvents.Contains(event);
+  }
+
+  bool Remove(const Pointer& event)
+  {
+    return Calendar ? CalendarEvents.Remove(event) : HeapEvents.Remove(event);
+  }
+
+  template<typename F>
+  void RemoveIf(F predicate)
+  {
+    if (Calendar) CalendarEvents.RemoveIf(predicate);
+    else HeapEvents.RemoveIf(predicate);
+  }
+
+  size_t GetCancelledCount() const
+  {
+    return Calendar ? CalendarEvents.GetCancelledCount() : HeapEvents.GetCancelledCount();
+  }
+
+  Array<Pointer> GetSorted(size_t max_count = SIZE_MAX) const
+  {
+    return Calendar ? CalendarEvents.GetSorted(max_count) : HeapEvents.GetSorted(max_count);
+  }
+
+private:
+
+  bool Calendar = false;
+
+  EventQueue<E> HeapEvents;
+  CalendarQueue<E> CalendarEvents;
+};
@@ -12,69 +12,605 @@
 #include "Vector2Stream.h"
 
 #include <limits>
+#include <cstring>
 #include <iomanip>
 #include <iterator>
 #include <algorithm>
 #include <execution>
+#include <type_traits>
 
 
 std::ostream& operator<<(std::ostream& stream, const EventsHistory::Event& event)
 {
   stream 
     << "Event[ID=" << event.ID 
-    << ",Time=" << event.Time
+    << ",Time=" << Ticks::ToSeconds(event.Time)
     << "]";
   return stream;
 }
 
 void EventsHistory::ScheduleEvent(std::shared_ptr<Event> event)
 {
-  EventsQueue += event;
+  EventsQueue.Push(event);
 }
 
 uint64_t EventsHistory::GetTotalSize() const
 {
-  return EventsHistory::Event::GetTotalEventsSize();
+  return SlabPool::GetTotalReservedBytes();
+}
+
+size_t EventsHistory::GetHeapBytes(const Bullet& bullet)
+{
+  return GetHeapBytes(bullet.Collision.WallIDs);
+}
+
+EventsHistory::Bounce::Bounce(const Bullet& old) :
+  BulletID(old.ID),
+  OldLifetime(old.Lifetime),
+  OldTime(old.Time),
+  OldLocation(old.Location),
+  OldDirection(old.Direction),
+  OldNormal(old.Collision.Normal),
+  OldWallIDs(old.Collision.WallIDs)
+{
+}
+
+void EventsHistory::Bounce::SetNew(const Bullet& bullet)
+{
+  Location = bullet.Location;
+  Direction = bullet.Direction;
+  Lifetime = bullet.Lifetime;
+
+  Hits = bullet.Collision.Hits;
+  CollisionTime = bullet.Collision.Time;
+  CollisionLocation = bullet.Collision.Location;
+  CollisionDirection = bullet.Collision.Direction;
+  CollisionNormal = bullet.Collision.Normal;
+  HorizonTime = bullet.Collision.HorizonTime;
+  WallIDs = WallSet(bullet.Collision.WallIDs);
+}
+
+void EventsHistory::Bounce::GetOld(Bullet& bullet, tick_t time) const
+{
+  bullet.Time = OldTime;
+  bullet.Location = OldLocation;
+  bullet.Direction = OldDirection;
+  bullet.Lifetime = OldLifetime;
+
+  bullet.Collision.Hits = true;
+  bullet.Collision.Time = time;
+  bullet.Collision.Location = Location;
+  bullet.Collision.Direction = Direction;
+  bullet.Collision.Normal = OldNormal;
+  bullet.Collision.HorizonTime = Ticks::Infinity;
+  bullet.Collision.WallIDs = OldWallIDs.ToSet();
+}
+
+void EventsHistory::Bounce::GetNew(Bullet& bullet, tick_t time) const
+{
+  bullet.Time = time;
+  bullet.Location = Location;
+  bullet.Direction = Direction;
+  bullet.Lifetime = Lifetime;
+
+  bullet.Collision.Hits = Hits;
+  bullet.Collision.Time = CollisionTime;
+  bullet.Collision.Location = CollisionLocation;
+  bullet.Collision.Direction = CollisionDirection;
+  bullet.Collision.Normal = CollisionNormal;
+  bullet.Collision.HorizonTime = HorizonTime;
+  bullet.Collision.WallIDs = WallIDs.ToSet();
+}
+
+EventsHistory::ScopedBounce::ScopedBounce(EventsHistory& History, tick_t time, const Bullet& target) :
+  History(History),
+  Time(time),
+  Target(target),
+  Data(target)
+{
+}
+
+EventsHistory::ScopedBounce::~ScopedBounce()
+{
+  Data.SetNew(Target);
+  History.ScheduleEvent<Bounce>(Time, Data);
+}
+
+tick_t EventsHistory::GetRewindHorizon() const
+{
+  if (Spill.size()) return Spill.GetFrontTime();
+  return EventsLog.size() ? EventsLog.Last()->Time : World::Get().CurrentTick;
+}
+
+// spill records: event header followed by the payload fields, wall id sets as a count and the ids
+
+#pragma pack(push, 4)
+
+struct SpillHeader
+{
+  uint64_t ID;
+  tick_t Time;
+  uint8_t Tag;
+  uint8_t Persistant;
+};
+
+#pragma pack(pop)
+
+template<typename T>
+static void Write(Array<uint8_t>& out, const T& value)
+{
+  static_assert(std::is_trivially_copyable<T>::value, "written as bytes");
+  const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+  out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+static void Write(Array<uint8_t>& out, const float2& value)
+{
+  Write(out, value.x);
+  Write(out, value.y);
+}
+
+static void Write(Array<uint8_t>& out, const LineSegment& value)
+{
+  Write(out, value.A);
+  Write(out, value.B);
+}
+
+// false once the record is exhausted
+struct SpillReader
+{
+  const uint8_t* Position;
+  const uint8_t* End;
+
+  template<typename T>
+  bool Read(T& value)
+  {
+    static_assert(std::is_trivially_copyable<T>::value, "read as bytes");
+    if (size_t(End - Position) < sizeof(T)) return false;
+    std::memcpy(&value, Position, sizeof(T));
+    Position += sizeof(T);
+    return true;
+  }
+
+  bool Read(float2& value)
+  {
+    return Read(value.x) && Read(value.y);
+  }
+
+  bool Read(LineSegment& value)
+  {
+    return Read(value.A) && Read(value.B);
+  }
+
+  bool ReadIDs(Set<uint32_t>& ids)
+  {
+    uint32_t count;
+    if (!Read(count)) return false;
+    ids.clear();
+    for (uint32_t id; count--; ids += id)
+      if (!Read(id)) return false;
+    return true;
+  }
+};
+
+template<typename Iter>
+static void WriteIDs(Array<uint8_t>& out, Iter first, Iter last, size_t count)
+{
+  Write(out, uint32_t(count));
+  for (; first != last; ++first)
+    Write(out, uint32_t(*first));
+}
+
+static void Write(Array<uint8_t>& out, const Bullet& bullet)
+{
+  Write(out, bullet.Time);
+  Write(out, bullet.ID);
+  Write(out, bullet.Location);
+  Write(out, bullet.Direction);
+  Write(out, bullet.Speed);
+  Write(out, bullet.Lifetime);
+  Write(out, bullet.Collision.Hits);
+  Write(out, bullet.Collision.Time);
+  Write(out, bullet.Collision.Location);
+  Write(out, bullet.Collision.Direction);
+  Write(out, bullet.Collision.Normal);
+  Write(out, bullet.Collision.HorizonTime);
+  Write(out, bullet.Collision.Generation);
+  WriteIDs(out, bullet.Collision.WallIDs.begin(), bullet.Collision.WallIDs.end(), bullet.Collision.WallIDs.size());
+}
+
+static bool Read(SpillReader& in, Bullet& bullet)
+{
+  return in.Read(bullet.Time)
+    && in.Read(bullet.ID)
+    && in.Read(bullet.Location)
+    && in.Read(bullet.Direction)
+    && in.Read(bullet.Speed)
+    && in.Read(bullet.Lifetime)
+    && in.Read(bullet.Collision.Hits)
+    && in.Read(bullet.Collision.Time)
+    && in.Read(bullet.Collision.Location)
+    && in.Read(bullet.Collision.Direction)
+    && in.Read(bullet.Collision.Normal)
+    && in.Read(bullet.Collision.HorizonTime)
+    && in.Read(bullet.Collision.Generation)
+    && in.ReadIDs(bullet.Collision.WallIDs);
+}
+
+static void Write(Array<uint8_t>& out, const Wall& wall)
+{
+  Write(out, wall.ID);
+  Write(out, wall.Ends);
+  Write(out, wall.Time);
+}
+
+static bool Read(SpillReader& in, Wall& wall)
+{
+  return in.Read(wall.ID) && in.Read(wall.Ends) && in.Read(wall.Time);
+}
+
+static void Write(Array<uint8_t>& out, const EventsHistory::Bounce& bounce)
+{
+  Write(out, bounce.BulletID);
+  Write(out, bounce.OldLifetime);
+  Write(out, bounce.OldTime);
+  Write(out, bounce.OldLocation);
+  Write(out, bounce.OldDirection);
+  Write(out, bounce.OldNormal);
+  WriteIDs(out, bounce.OldWallIDs.begin(), bounce.OldWallIDs.end(), bounce.OldWallIDs.size());
+  Write(out, bounce.Location);
+  Write(out, bounce.Direction);
+  Write(out, bounce.Lifetime);
+  Write(out, bounce.Hits);
+  Write(out, bounce.CollisionTime);
+  Write(out, bounce.CollisionLocation);
+  Write(out, bounce.CollisionDirection);
+  Write(out, bounce.CollisionNormal);
+  Write(out, bounce.HorizonTime);
+  WriteIDs(out, bounce.WallIDs.begin(), bounce.WallIDs.end(), bounce.WallIDs.size());
+}
+
+static bool Read(SpillReader& in, EventsHistory::Bounce& bounce)
+{
+  Set<uint32_t> old_wall_ids, wall_ids;
+
+  const bool valid = in.Read(bounce.BulletID)
+    && in.Read(bounce.OldLifetime)
+    && in.Read(bounce.OldTime)
+    && in.Read(bounce.OldLocation)
+    && in.Read(bounce.OldDirection)
+    && in.Read(bounce.OldNormal)
+    && in.ReadIDs(old_wall_ids)
+    && in.Read(bounce.Location)
+    && in.Read(bounce.Direction)
+    && in.Read(bounce.Lifetime)
+    && in.Read(bounce.Hits)
+    && in.Read(bounce.CollisionTime)
+    && in.Read(bounce.CollisionLocation)
+    && in.Read(bounce.CollisionDirection)
+    && in.Read(bounce.CollisionNormal)
+    && in.Read(bounce.HorizonTime)
+    && in.ReadIDs(wall_ids);
+
+  bounce.OldWallIDs = EventsHistory::WallSet(old_wall_ids);
+  bounce.WallIDs = EventsHistory::WallSet(wall_ids);
+
+  return valid;
+}
+
+template<typename T>
+static void Write(Array<uint8_t>& out, const EventsHistory::Add<T>& data) { Write(out, data.Value); }
+template<typename T>
+static void Write(Array<uint8_t>& out, const EventsHistory::Remove<T>& data) { Write(out, data.Value); }
+template<typename T>
+static void Write(Array<uint8_t>& out, const EventsHistory::Update<T>& data) { Write(out, data.Old); Write(out, data.New); }
+
+template<typename T>
+static bool Read(SpillReader& in, EventsHistory::Add<T>& data) { return Read(in, data.Value); }
+template<typename T>
+static bool Read(SpillReader& in, EventsHistory::Remove<T>& data) { return Read(in, data.Value); }
+template<typename T>
+static bool Read(SpillReader& in, EventsHistory::Update<T>& data) { return Read(in, data.Old) && Read(in, data.New); }
+
+template<typename T>
+static void WritePayload(Array<uint8_t>& out, const std::shared_ptr<EventsHistory::Event>& event)
+{
+  Write(out, std::static_pointer_cast<EventsHistory::EventData<T>>(event)->Data);
+}
+
+template<typename T>
+static std::shared_ptr<EventsHistory::Event> ReadPayload(SpillReader& in, const SpillHeader& header)
+{
+  T data;
+  if (!Read(in, data)) return nullptr;
+
+  std::shared_ptr<EventsHistory::Event> event = EventsHistory::MakeEvent<T>(header.Time, data, header.Persistant != 0);
+  event->ID = header.ID;
+  return event;
+}
+
+void EventsHistory::UpdateSpill()
+{
+  if (Config::HistorySpillBytes == Spill.GetCapacity()) return;
+
+  Spill.Close();
+
+  if (!Config::HistorySpillBytes) return;
+
+  if (!Spill.Open(Config::HistorySpillPath, Config::HistorySpillBytes))
+  {
+    LOG_ERROR << "can't map history spill file " << Config::HistorySpillPath;
+    Config::HistorySpillBytes = 0;
+  }
+}
+
+void EventsHistory::SpillEvent(const std::shared_ptr<Event>& event)
+{
+  static Array<uint8_t> buffer;
+  buffer.clear();
+
+  Write(buffer, SpillHeader{ event->ID, event->Time, event->Tag, uint8_t(event->Persistant) });
+
+  switch (event->Tag)
+  {
+  case TAG_ADD_BULLET: WritePayload<Add<Bullet>>(buffer, event); break;
+  case TAG_REMOVE_BULLET: WritePayload<Remove<Bullet>>(buffer, event); break;
+  case TAG_UPDATE_BULLET: WritePayload<Update<Bullet>>(buffer, event); break;
+  case TAG_ADD_WALL: WritePayload<Add<Wall>>(buffer, event); break;
+  case TAG_REMOVE_WALL: WritePayload<Remove<Wall>>(buffer, event); break;
+  case TAG_UPDATE_WALL: WritePayload<Update<Wall>>(buffer, event); break;
+  case TAG_BOUNCE: WritePayload<Bounce>(buffer, event); break;
+
+  // search events aren't logged
+  default: return;
+  }
+
+  Spill.Push(event->Time, buffer.data(), buffer.size());
+}
+
+void EventsHistory::UnspillEvents(tick_t time)
+{
+  if (!Spill.size() || Spill.GetBackTime() < time) return;
+
+  // newest first, each one is older than everything in EventsLog
+  while (Spill.size() && Spill.GetBackTime() >= time)
+  {
+    size_t count;
+    const uint8_t* bytes = Spill.GetBack(count);
+
+    SpillReader in{ bytes, bytes + count };
+
+    SpillHeader header;
+    std::shared_ptr<Event> event;
+
+    if (in.Read(header))
+    {
+      switch (header.Tag)
+      {
+      case TAG_ADD_BULLET: event = ReadPayload<Add<Bullet>>(in, header); break;
+      case TAG_REMOVE_BULLET: event = ReadPayload<Remove<Bullet>>(in, header); break;
+      case TAG_UPDATE_BULLET: event = ReadPayload<Update<Bullet>>(in, header); break;
+      case TAG_ADD_WALL: event = ReadPayload<Add<Wall>>(in, header); break;
+      case TAG_REMOVE_WALL: event = ReadPayload<Remove<Wall>>(in, header); break;
+      case TAG_UPDATE_WALL: event = ReadPayload<Update<Wall>>(in, header); break;
+      case TAG_BOUNCE: event = ReadPayload<Bounce>(in, header); break;
+      }
+    }
+
+    Spill.PopBack();
+
+    if (event) LogEvent(event);
+    else LOG_ERROR << "dropped a damaged history spill record";
+  }
+
+  // what is older stays in the spill
+  EvictedTime = Spill.size() ? Spill.GetBackTime() : -Ticks::Infinity;
+}
+
+// std::set node holding an index entry
+static constexpr size_t IndexEntryBytes = sizeof(std::shared_ptr<EventsHistory::Event>) + 4 * sizeof(void*);
+
+void EventsHistory::LogEvent(std::shared_ptr<Event> event)
+{
+  LogBytes += event->Size + IndexEntryBytes;
+  EventsLog += event;
+  ++KeyframeEventCount;
+
+  (IsWallEvent(event) ? WallEvents : BulletEvents)[GetEntityID(event)] += event;
+
+  if (event->Tag == TAG_BOUNCE)
+  {
+    LogBytes += IndexEntryBytes;
+    BounceEvents += event;
+  }
+}
+
+void EventsHistory::UnlogEvent(const std::shared_ptr<Event>& event)
+{
+  LogBytes -= event->Size + IndexEntryBytes;
+
+  std::unordered_map<uint32_t, EventsLogSet>& index = IsWallEvent(event) ? WallEvents : BulletEvents;
+  auto iter = index.find(GetEntityID(event));
+  if (iter != index.end())
+  {
+    iter->second.Remove(event);
+    if (!iter->second.size()) index.erase(iter);
+  }
+
+  if (event->Tag == TAG_BOUNCE && BounceEvents.Remove(event))
+    LogBytes -= IndexEntryBytes;
+}
+
+const EventsHistory::EventsLogSet* EventsHistory::GetBulletEvents(uint32_t bullet_id) const
+{
+  auto iter = BulletEvents.find(bullet_id);
+  return (iter == BulletEvents.end()) ? nullptr : &iter->second;
+}
+
+const EventsHistory::EventsLogSet* EventsHistory::GetWallEvents(uint32_t wall_id) const
+{
+  auto iter = WallEvents.find(wall_id);
+  return (iter == WallEvents.end()) ? nullptr : &iter->second;
+}
+
+std::shared_ptr<EventsHistory::Event> EventsHistory::GetLastBulletEvent(uint32_t bullet_id) const
+{
+  const EventsLogSet* events = GetBulletEvents(bullet_id);
+  return events ? events->First() : nullptr;
+}
+
+uint32_t EventsHistory::GetEntityID(const std::shared_ptr<Event>& event)
+{
+  switch (event->Tag)
+  {
+  case TAG_ADD_BULLET: return Cast<Add<Bullet>>(event)->Data.Value.ID;
+  case TAG_REMOVE_BULLET: return Cast<Remove<Bullet>>(event)->Data.Value.ID;
+  case TAG_UPDATE_BULLET: return Cast<Update<Bullet>>(event)->Data.New.ID;
+  case TAG_ADD_WALL: return Cast<Add<Wall>>(event)->Data.Value.ID;
+  case TAG_REMOVE_WALL: return Cast<Remove<Wall>>(event)->Data.Value.ID;
+  case TAG_UPDATE_WALL: return Cast<Update<Wall>>(event)->Data.New.ID;
+  case TAG_COLLISION: return Cast<Collision>(event)->Data.BulletID;
+  case TAG_HORIZON: return Cast<Horizon>(event)->Data.BulletID;
+  case TAG_CELL_CROSSING: return Cast<CellCrossing>(event)->Data.BulletID;
+  case TAG_BOUNCE: return Cast<Bounce>(event)->Data.BulletID;
+  }
+
+  return 0;
+}
+
+const char* EventsHistory::GetTagName(EventTag tag)
+{
+  switch (tag)
+  {
+  case TAG_ADD_BULLET: return "add bullet";
+  case TAG_REMOVE_BULLET: return "remove bullet";
+  case TAG_UPDATE_BULLET: return "update bullet";
+  case TAG_ADD_WALL: return "add wall";
+  case TAG_REMOVE_WALL: return "remove wall";
+  case TAG_UPDATE_WALL: return "update wall";
+  case TAG_COLLISION: return "collision";
+  case TAG_HORIZON: return "horizon";
+  case TAG_CELL_CROSSING: return "cell crossing";
+  case TAG_BOUNCE: return "bounce";
+  }
+
+  return "unknown";
+}
+
+bool EventsHistory::IsWallEvent(const std::shared_ptr<Event>& event)
+{
+  return event->Tag == TAG_ADD_WALL || event->Tag == TAG_REMOVE_WALL || event->Tag == TAG_UPDATE_WALL;
+}
+
+void EventsHistory::UpdateKeyframes()
+{
+  World& world = World::Get();
+
+  const size_t keyframe_cost = world.Bullets.size() + world.Walls.size();
+
+  if (double(KeyframeEventCount) < Max(keyframe_cost * Config::KeyframeEventRatio, 256.0)) return;
+
+  if (Keyframes.size() && Keyframes.back().Time >= world.CurrentTick) return;
+
+  // Cleanup would drop it right away, see there
+  if (sizeof(Keyframe) + world.Bullets.size() * sizeof(Bullet) + world.Walls.size() * sizeof(Wall) > Config::HistoryMaxBytes / 2) return;
+
+  if (Keyframes.size()) Keyframes.back().EventCount = KeyframeEventCount;
+
+  Keyframe keyframe;
+  keyframe.Time = world.CurrentTick;
+
+  keyframe.Bullets.assign(world.Bullets.begin(), world.Bullets.end());
+  keyframe.Walls.reserve(world.Walls.size());
+  world.Walls.ForEach([&keyframe](Wall& wall)
+  {
+    keyframe.Walls.push_back(wall);
+  });
+
+  keyframe.Size = sizeof(Keyframe)
+    + keyframe.Bullets.size() * sizeof(Bullet)
+    + keyframe.Walls.size() * sizeof(Wall);
+  for (const Bullet& bullet : keyframe.Bullets)
+    keyframe.Size += GetHeapBytes(bullet);
+
+  LogBytes += keyframe.Size;
+  Keyframes.push_back(std::move(keyframe));
+
+  KeyframeEventCount = 0;
 }
 
 void EventsHistory::Cleanup()
 {
-  double event_min_time = World::Time() - Config::HistoryMaxAge;
+  UpdateSpill();
+
+  const tick_t event_min_time = World::Time() - Ticks::FromSeconds(Config::HistoryMaxAge);
+
+  // keyframes only make rewinds shorter, dropping one doesn't move the horizon. they get half the budget at most,
+  // otherwise keyframes alone could push every event out and the horizon up to now
+  size_t keyframe_bytes = 0;
+  for (const Keyframe& keyframe : Keyframes)
+    keyframe_bytes += keyframe.Size;
+
+  size_t dropped = 0;
+  while (dropped < Keyframes.size() && keyframe_bytes > Config::HistoryMaxBytes / 2)
+  {
+    keyframe_bytes -= Keyframes[dropped].Size;
+    LogBytes -= Keyframes[dropped++].Size;
+  }
+  Keyframes.erase(Keyframes.begin(), Keyframes.begin() + dropped);
 
-  while (EventsLog.PopLastIf([event_min_time](const std::shared_ptr<EventsHistory::Event>& event)
+  // oldest events go first, by age or to fit the memory budget
+  while (EventsLog.PopLastIf([this, event_min_time](const std::shared_ptr<EventsHistory::Event>& event)
   {
-    return event->Time < event_min_time;
+    if (event->Time >= event_min_time && LogBytes <= Config::HistoryMaxBytes) return false;
+    UnlogEvent(event);
+    if (Spill.IsOpen()) SpillEvent(event);
+    EvictedTime = Max(EvictedTime, event->Time);
+    return true;
   }));
+
+  size_t expired = 0;
+  while (expired < Keyframes.size() && Keyframes[expired].Time < EvictedTime)
+    LogBytes -= Keyframes[expired++].Size;
+  Keyframes.erase(Keyframes.begin(), Keyframes.begin() + expired);
 }
 
 bool EventsHistory::ApplyEvent(std::shared_ptr<Event> event)
 {
   if (!event) return false;
 
+  ++ProcessedEvents;
+
   if ([&]() 
   {
-    if (ApplyEventCastAndCall<Add<Bullet>>(event)) return true;
-    if (ApplyEventCastAndCall<Remove<Bullet>>(event)) return true;
-    if (ApplyEventCastAndCall<Update<Bullet>>(event)) return true;
-
-    if (ApplyEventCastAndCall<Add<Wall>>(event)) return true;
-    if (ApplyEventCastAndCall<Remove<Wall>>(event)) return true;
-    if (ApplyEventCastAndCall<Update<Wall>>(event)) return true;
-
-    if (ApplyEventCastAndCall<Collision>(event)) return true;
+    switch (event->Tag)
+    {
+    case TAG_ADD_BULLET: return ApplyEventCastAndCall<Add<Bullet>>(event);
+    case TAG_REMOVE_BULLET: return ApplyEventCastAndCall<Remove<Bullet>>(event);
+    case TAG_UPDATE_BULLET: return ApplyEventCastAndCall<Update<Bullet>>(event);
+
+    case TAG_ADD_WALL: return ApplyEventCastAndCall<Add<Wall>>(event);
+    case TAG_REMOVE_WALL: return ApplyEventCastAndCall<Remove<Wall>>(event);
+    case TAG_UPDATE_WALL: return ApplyEventCastAndCall<Update<Wall>>(event);
+
+    case TAG_COLLISION: return ApplyEventCastAndCall<Collision>(event);
+    case TAG_HORIZON: return ApplyEventCastAndCall<Horizon>(event);
+    case TAG_CELL_CROSSING: return ApplyEventCastAndCall<CellCrossing>(event);
+    case TAG_BOUNCE: return ApplyEventCastAndCall<Bounce>(event);
+    }
 
     return false;
   }())
   {
     World::Time() = event->Time;
-    EventsLog += event;
+    LogEvent(event);
     return true;
   }
 
   return false;
 }
 
-Bullet& UpdateCollision(Bullet& bullet, double time)
+Bullet& UpdateCollision(Bullet& bullet, tick_t time)
 {
   World& world = World::Get();
 
@@ -86,33 +622,52 @@ Bullet& UpdateCollision(Bullet& bullet, double time)
 
 bool EventsHistory::ApplyEvent(std::shared_ptr<EventData<Add<Bullet>>> event)
 {
-  ScheduleCollisionEvent(UpdateCollision(World::Get().Bullets.Add(event->Data.Value), event->Data.Value.Time));
+  ScheduleCollisionEvent(UpdateCollision(World::Get().AddBullet(event->Data.Value), event->Data.Value.Time));
   return true;
 }
 
 bool EventsHistory::ApplyEvent(std::shared_ptr<EventData<Remove<Bullet>>> event)
 {
-  World::Get().Bullets.Remove(event->Data.Value.ID);
+  CancelCollisionEvent(event->Data.Value.ID);
+  World::Get().RemoveBullet(event->Data.Value.ID);
   return true;
 }
 
 bool EventsHistory::ApplyEvent(std::shared_ptr<EventData<Update<Bullet>>> event)
 {
-  ScheduleCollisionEvent(World::Get().Bullets.Add(event->Data.New));
+  ScheduleCollisionEvent(World::Get().AddBullet(event->Data.New));
+  return true;
+}
+
+bool EventsHistory::ApplyEvent(std::shared_ptr<EventData<Bounce>> event)
+{
+  World& world = World::Get();
+
+  Bullet* bullet = world.Bullets.Get(event->Data.BulletID);
+
+  if (!bullet) return false;
+
+  event->Data.GetNew(*bullet, event->Time);
+  world.UpdateBullet(*bullet);
+
+  ScheduleCollisionEvent(*bullet);
   return true;
 }
 
 bool EventsHistory::ApplyEvent(std::shared_ptr<EventData<Add<Wall>>> event)
 {
   World& world = World::Get();
-  for (Bullet* bullet : world.GetManager<BulletManager>()->WallAdded(world.Walls.Add(event->Data.Value)))
+  for (Bullet* bullet : world.GetManager<BulletManager>()->WallAdded(world.AddWall(event->Data.Value)))
     ScheduleCollisionEvent(*bullet);
   return true;
 }
 
 bool EventsHistory::ApplyEvent(std::shared_ptr<EventData<Remove<Wall>>> event)
 {
-  World::Get().Walls.Remove(event->Data.Value.ID);
+  World& world = World::Get();
+  world.RemoveWall(event->Data.Value.ID);
+  for (Bullet* bullet : world.GetManager<BulletManager>()->WallRemoved(event->Data.Value.ID))
+    ScheduleCollisionEvent(*bullet);
   return true;
 }
 
@@ -120,11 +675,14 @@ bool EventsHistory::ApplyEvent(std::shared_ptr<EventData<Update<Wall>>> event)
 {
   World& world = World::Get();
 
-  Wall* wall = world.Walls.Get(event->Data.Old.ID);
+  BulletManager* bullet_manager = world.GetManager<BulletManager>();
+
+  const Wall& wall = world.AddWall(event->Data.New);
 
-  for (auto& bullet : world.GetManager<BulletManager>()->WallAdded(wall
-    ? (*wall = event->Data.New)
-    : world.Walls.Add(event->Data.New)))
+  Set<Bullet*> bullets = bullet_manager->WallRemoved(wall.ID);
+  bullets += bullet_manager->WallAdded(wall);
+
+  for (auto& bullet : bullets)
   {
     ScheduleCollisionEvent(*bullet);
   }
@@ -138,7 +696,7 @@ bool EventsHistory::ApplyEvent(std::shared_ptr<EventData<Collision>> event)
 
   Bullet* bullet = world.Bullets.Get(event->Data.BulletID);
 
-  if (!bullet) return false;
+  if (!IsCollisionEventLive(bullet, event->Data.Generation)) return false;
 
   if (!bullet->Collision.Hits) return false;
 
@@ -146,10 +704,22 @@ bool EventsHistory::ApplyEvent(std::shared_ptr<EventData<Collision>> event)
 
   if (!bullet->Collision.WallIDs.size()) return false;
 
-  if (event->Data.WallIDs != bullet->Collision.WallIDs) return false;
+  // with all of its walls in place the hit is applied as is and the bullet bounces at the collision location
+  bool bounces = true;
+  for (Wall::id_t wall_id : bullet->Collision.WallIDs)
+    bounces = bounces && world.Walls.Get(wall_id);
+
+  ++world.GetManager<BulletManager>()->Stats.CollisionCount;
 
   Set<Wall::id_t> hit_walls;
-  double bullet_time = bullet->Collision.Time;
+  tick_t bullet_time = bullet->Collision.Time;
+  if (bounces)
+  {
+    EventsHistory::ScopedBounce update(world.History, bullet_time, *bullet);
+    hit_walls = bullet->ApplyCollision();
+    world.GetManager<BulletManager>()->UpdateBulletCollision(*bullet, bullet_time);
+  }
+  else
   {
     EventsHistory::ScopedUpdate<Bullet> update(world.History, bullet_time, *bullet);
     hit_walls = bullet->ApplyCollision();
@@ -168,47 +738,312 @@ bool EventsHistory::ApplyEvent(std::shared_ptr<EventData<Collision>> event)
   return false;
 }
 
-void EventsHistory::Rewind(double time)
+bool EventsHistory::ApplyEvent(std::shared_ptr<EventData<Horizon>> event)
 {
   World& world = World::Get();
 
+  Bullet* bullet = world.Bullets.Get(event->Data.BulletID);
+
+  if (!IsCollisionEventLive(bullet, event->Data.Generation)) return false;
+
+  if (bullet->Collision.Hits) return false;
+
+  if (bullet->Collision.HorizonTime != event->Time) return false;
+
+  {
+    EventsHistory::ScopedUpdate<Bullet> update(world.History, event->Time, *bullet);
+    world.GetManager<BulletManager>()->UpdateBulletCollision(*bullet, event->Time);
+  }
+
+  return false;
+}
+
+bool EventsHistory::ApplyEvent(std::shared_ptr<EventData<CellCrossing>> event)
+{
+  World& world = World::Get();
+
+  Bullet* bullet = world.Bullets.Get(event->Data.BulletID);
+
+  if (!IsCollisionEventLive(bullet, event->Data.Generation)) return false;
+
+  if (bullet->Collision.Hits) return false;
+
+  if (bullet->Collision.HorizonTime != event->Time) return false;
+
+  {
+    // the bullet is rebased on the boundary so its path covers the new cell only
+    EventsHistory::ScopedUpdate<Bullet> update(world.History, event->Time, *bullet);
+    bullet->MoveTo(event->Time);
+    world.GetManager<BulletManager>()->UpdateBulletCollision(*bullet, event->Time);
+  }
+
+  return false;
+}
+
+void EventsHistory::Rewind(tick_t time)
+{
+  World& world = World::Get();
+
+  UnspillEvents(time);
+
+  // the latest keyframe before the time, worth restoring when more events than
+  // the keyframe holds would have to be reverted. the replay is shorter than that by construction
+  size_t keyframe_index = Keyframes.size();
+  while (keyframe_index > 0 && Keyframes[keyframe_index - 1].Time >= time)
+    --keyframe_index;
+
+  if (keyframe_index > 0)
+  {
+    const Keyframe& keyframe = Keyframes[keyframe_index - 1];
+    const size_t keyframe_cost = keyframe.Bullets.size() + keyframe.Walls.size();
+
+    size_t revert_count = 0;
+    for (const std::shared_ptr<Event>& event : EventsLog)
+    {
+      if (event->Time < time || ++revert_count > keyframe_cost) break;
+    }
+
+    if (revert_count > keyframe_cost)
+    {
+      RewindToKeyframe(keyframe_index - 1, time);
+      return;
+    }
+  }
+
+  // keyframes from the time on hold events about to be reverted
+  const bool keyframes_dropped = keyframe_index < Keyframes.size();
+  for (size_t i = keyframe_index; i < Keyframes.size(); ++i)
+    LogBytes -= Keyframes[i].Size;
+  Keyframes.erase(Keyframes.begin() + keyframe_index, Keyframes.end());
+
   while (EventsLog.PopFirstIf([this, time, &world](const std::shared_ptr<EventsHistory::Event>& event)
   {
     if (event->Time < time) return false;
 
     World::Time() = event->Time;
 
+    UnlogEvent(event);
+    if (KeyframeEventCount) --KeyframeEventCount;
+
     this->RevertEvent(event);
 
     return true;
   }));
 
   World::Time() = time;
+
+  // counted again from the keyframe before, newest events come first
+  if (keyframes_dropped)
+  {
+    KeyframeEventCount = 0;
+    for (const std::shared_ptr<Event>& event : EventsLog)
+    {
+      if (Keyframes.size() && event->Time <= Keyframes.back().Time) break;
+      ++KeyframeEventCount;
+    }
+  }
+
+  UpdatePendingCollisions();
+}
+
+void EventsHistory::RewindToKeyframe(size_t keyframe_index, tick_t time)
+{
+  World& world = World::Get();
+
+  // events from the time on are dropped instead of reverted
+  while (EventsLog.PopFirstIf([this, time](const std::shared_ptr<EventsHistory::Event>& event)
+  {
+    if (event->Time < time) return false;
+
+    UnlogEvent(event);
+
+    if (event->Persistant) EventsQueue.Push(event);
+
+    return true;
+  }));
+
+  for (size_t i = keyframe_index + 1; i < Keyframes.size(); ++i)
+    LogBytes -= Keyframes[i].Size;
+  Keyframes.erase(Keyframes.begin() + keyframe_index + 1, Keyframes.end());
+
+  const Keyframe& keyframe = Keyframes[keyframe_index];
+
+  Array<std::shared_ptr<Event>> replay;
+  for (const std::shared_ptr<Event>& event : EventsLog)
+  {
+    if (event->Time <= keyframe.Time) break;
+    replay.push_back(event);
+  }
+
+  KeyframeEventCount = replay.size();
+
+  // expiries are computed against the clock, it has to be at the keyframe before the bullets come back
+  World::Time() = keyframe.Time;
+  world.Restore(keyframe.Bullets, keyframe.Walls);
+
+  // the queue keeps the searches of bullets as they are now
+  EventsQueue.RemoveIf([](const std::shared_ptr<Event>& event)
+  {
+    return event->Tag == TAG_COLLISION || event->Tag == TAG_HORIZON || event->Tag == TAG_CELL_CROSSING;
+  });
+  CollisionEvents.clear();
+  PendingCollisionUpdates.clear();
+
+  Replaying = true;
+  for (auto iter = replay.rbegin(); iter != replay.rend(); ++iter)
+  {
+    World::Time() = (*iter)->Time;
+    ReplayEvent(*iter);
+  }
+  Replaying = false;
+
+  World::Time() = time;
+
+  world.Bullets.ForEach([this](Bullet& bullet)
+  {
+    ScheduleCollisionEvent(bullet);
+  });
 }
 
-void EventsHistory::ProcessEventsQueue(double time)
+void EventsHistory::ReplayEvent(std::shared_ptr<Event> event)
 {
-  while (EventsQueue.size() && ProcessEventsQueueSingle(time));
+  // same handlers as ApplyEvent without logging the event again
+  switch (event->Tag)
+  {
+  case TAG_ADD_BULLET: ApplyEventCastAndCall<Add<Bullet>>(event); break;
+  case TAG_REMOVE_BULLET: ApplyEventCastAndCall<Remove<Bullet>>(event); break;
+  case TAG_UPDATE_BULLET: ApplyEventCastAndCall<Update<Bullet>>(event); break;
+  case TAG_BOUNCE: ApplyEventCastAndCall<Bounce>(event); break;
+
+  case TAG_ADD_WALL: ApplyEventCastAndCall<Add<Wall>>(event); break;
+  case TAG_REMOVE_WALL: ApplyEventCastAndCall<Remove<Wall>>(event); break;
+  case TAG_UPDATE_WALL: ApplyEventCastAndCall<Update<Wall>>(event); break;
+
+  default: break;
+  }
 }
 
-std::shared_ptr<EventsHistory::Event> EventsHistory::GetNextEvent(double max_time, bool remove)
+void EventsHistory::UpdatePendingCollisions()
 {
-  if (!EventsQueue.size()) 
-    return std::shared_ptr<EventsHistory::Event>();
+  if (!PendingCollisionUpdates.size()) return;
+
+  World& world = World::Get();
+
+  Array<Bullet*> bullets;
+  Array<tick_t> times;
+
+  for (auto& pair : PendingCollisionUpdates)
+  {
+    Bullet* bullet = world.Bullets.Get(pair.first);
+    if (!bullet) continue;
+    bullets.push_back(bullet);
+    times.push_back(pair.second);
+  }
+
+  PendingCollisionUpdates.clear();
+  CollisionEvents.clear();
 
-  auto iter = EventsQueue.begin();
+  world.GetManager<BulletManager>()->UpdateBulletCollisions(bullets, times);
 
-  std::shared_ptr<EventsHistory::Event> event = *(iter);
+  for (Bullet* bullet : bullets)
+    ScheduleCollisionEvent(*bullet);
+}
+
+void EventsHistory::ProcessEventsQueue(tick_t time)
+{
+  EventsQueue.SetCalendar(Config::UseCalendarQueue);
 
-  if (event->Time > max_time)
+  while (EventsQueue.size())
+  {
+    PeakQueueSize = Max(PeakQueueSize, EventsQueue.size());
+    if (!ProcessAddBulletEvents(time) && !ProcessEventsQueueSingle(time)) break;
+  }
+}
+
+// bullets added back to back can't affect each other until the first of their
+// collisions is due, so their collisions are computed together
+bool EventsHistory::ProcessAddBulletEvents(tick_t time)
+{
+  World& world = World::Get();
+
+  Array<std::shared_ptr<EventData<Add<Bullet>>>> events;
+
+  // the run is taken off the queue, what isn't processed is put back
+  while (EventsQueue.size())
+  {
+    const std::shared_ptr<Event>& event = EventsQueue.Top();
+
+    if (event->Time > time || event->Time < World::Time()) break;
+
+    auto add_event = Cast<Add<Bullet>>(event);
+    if (!add_event) break;
+
+    EventsQueue.Pop();
+    events.push_back(add_event);
+  }
+
+  if (!events.size()) return false;
+
+  const bool batch = events.size() >= Config::ParallelCollisionBatchSize;
+
+  Array<Bullet> bullets;
+
+  if (batch)
+  {
+    Array<Bullet*> bullet_ptrs;
+    Array<tick_t> times;
+
+    bullets.reserve(events.size());
+    for (const auto& event : events)
+    {
+      bullets.push_back(event->Data.Value);
+      bullet_ptrs.push_back(&bullets.back());
+      times.push_back(event->Data.Value.Time);
+    }
+
+    world.GetManager<BulletManager>()->FindBulletCollisions(bullet_ptrs, times);
+  }
+
+  size_t processed = 0;
+  for (; processed < events.size(); ++processed)
+  {
+    const std::shared_ptr<EventData<Add<Bullet>>>& event = events[processed];
+
+    // events scheduled by the bullets added so far go first, the rest is processed after them
+    if (EventsQueue.size() && EventsCompare<std::less>()(EventsQueue.Top(), event)) break;
+
+    World::Time() = event->Time;
+
+    if (!batch)
+    {
+      ApplyEvent(std::static_pointer_cast<Event>(event));
+      continue;
+    }
+
+    ScheduleCollisionEvent(world.AddBullet(bullets[processed]));
+
+    LogEvent(event);
+    ++ProcessedEvents;
+  }
+
+  for (size_t i = processed; i < events.size(); ++i)
+    EventsQueue.Push(events[i]);
+
+  return true;
+}
+
+std::shared_ptr<EventsHistory::Event> EventsHistory::GetNextEvent(tick_t max_time, bool remove)
+{
+  if (!EventsQueue.size()) 
     return std::shared_ptr<EventsHistory::Event>();
 
-  if (remove) EventsQueue.erase(iter);
+  if (EventsQueue.Top()->Time > max_time)
+    return std::shared_ptr<EventsHistory::Event>();
 
-  return event;
+  return remove ? EventsQueue.Pop() : EventsQueue.Top();
 }
 
-bool EventsHistory::ProcessEventsQueueSingle(double time)
+bool EventsHistory::ProcessEventsQueueSingle(tick_t time)
 {
   auto event = PopNextEvent(time);
 
@@ -216,7 +1051,7 @@ bool EventsHistory::ProcessEventsQueueSingle(double time)
 
   if (event->Time < World::Time())
   {
-    if (event->Persistant) EventsQueue.Add(event);
+    if (event->Persistant) EventsQueue.Push(event);
     Rewind(event->Time);
     return true;
   }
@@ -232,15 +1067,21 @@ void EventsHistory::RevertEvent(std::shared_ptr<Event> event)
 {
   if ([this, event]() 
   {
-    if (RevertEventCastAndCall<EventData<Add<Bullet>>>(event)) return true;
-    if (RevertEventCastAndCall<EventData<Remove<Bullet>>>(event)) return true;
-    if (RevertEventCastAndCall<EventData<Update<Bullet>>>(event)) return true;
-
-    if (RevertEventCastAndCall<EventData<Add<Wall>>>(event)) return true;
-    if (RevertEventCastAndCall<EventData<Remove<Wall>>>(event)) return true;
-    if (RevertEventCastAndCall<EventData<Update<Wall>>>(event)) return true;
-
-    if (RevertEventCastAndCall<EventData<Collision>>(event)) return true;
+    switch (event->Tag)
+    {
+    case TAG_ADD_BULLET: return RevertEventCastAndCall<EventData<Add<Bullet>>>(event);
+    case TAG_REMOVE_BULLET: return RevertEventCastAndCall<EventData<Remove<Bullet>>>(event);
+    case TAG_UPDATE_BULLET: return RevertEventCastAndCall<EventData<Update<Bullet>>>(event);
+
+    case TAG_ADD_WALL: return RevertEventCastAndCall<EventData<Add<Wall>>>(event);
+    case TAG_REMOVE_WALL: return RevertEventCastAndCall<EventData<Remove<Wall>>>(event);
+    case TAG_UPDATE_WALL: return RevertEventCastAndCall<EventData<Update<Wall>>>(event);
+
+    case TAG_COLLISION: return RevertEventCastAndCall<EventData<Collision>>(event);
+    case TAG_HORIZON: return RevertEventCastAndCall<EventData<Horizon>>(event);
+    case TAG_CELL_CROSSING: return RevertEventCastAndCall<EventData<CellCrossing>>(event);
+    case TAG_BOUNCE: return RevertEventCastAndCall<EventData<Bounce>>(event);
+    }
 
     return false;
   }())
@@ -249,14 +1090,17 @@ void EventsHistory::RevertEvent(std::shared_ptr<Event> event)
 
     if (event->Persistant)
     {
-      EventsQueue.Add(event);
+      EventsQueue.Push(event);
     }
   }
 }
 
 void EventsHistory::RevertEvent(std::shared_ptr<EventData<Add<Bullet>>> event)
 {
-  if (!World::Get().Bullets.Remove(event->Data.Value.ID))
+  PendingCollisionUpdates.Remove(event->Data.Value.ID);
+  CancelCollisionEvent(event->Data.Value.ID);
+
+  if (!World::Get().RemoveBullet(event->Data.Value.ID))
   {
     LOG_WARNING << "revert event: no bullet found for id " << event->Data.Value.ID;
   }
@@ -264,28 +1108,54 @@ void EventsHistory::RevertEvent(std::shared_ptr<EventData<Add<Bullet>>> event)
 
 void EventsHistory::RevertEvent(std::shared_ptr<EventData<Remove<Bullet>>> event)
 {
-  ScheduleCollisionEvent(UpdateCollision(World::Get().Bullets.Add(event->Data.Value), event->Time));
+  World::Get().AddBullet(event->Data.Value);
+
+  // computed once the rewind is done unless an earlier event restores the bullet
+  PendingCollisionUpdates.Add(event->Data.Value.ID, event->Time);
 }
 
 void EventsHistory::RevertEvent(std::shared_ptr<EventData<Update<Bullet>>> event)
 {
   World& world = World::Get();
-  
-  ScheduleCollisionEvent(world.Bullets.Add(event->Data.Old));
+
+  PendingCollisionUpdates.Remove(event->Data.New.ID);
+
+  ScheduleCollisionEvent(world.AddBullet(event->Data.Old));
+}
+
+void EventsHistory::RevertEvent(std::shared_ptr<EventData<Bounce>> event)
+{
+  World& world = World::Get();
+
+  PendingCollisionUpdates.Remove(event->Data.BulletID);
+
+  Bullet* bullet = world.Bullets.Get(event->Data.BulletID);
+
+  if (!bullet) return;
+
+  event->Data.GetOld(*bullet, event->Time);
+  world.UpdateBullet(*bullet);
+
+  ScheduleCollisionEvent(*bullet);
 }
 
 void EventsHistory::RevertEvent(std::shared_ptr<EventData<Add<Wall>>> event)
 {
-  if (!World::Get().Walls.Remove(event->Data.Value.ID))
+  World& world = World::Get();
+
+  if (!world.RemoveWall(event->Data.Value.ID))
   {
     LOG_WARNING << "revert event: wall does not exit: " << event->Data.Value.ID;
   }
+
+  for (Bullet* bullet : world.GetManager<BulletManager>()->WallRemoved(event->Data.Value.ID))
+    ScheduleCollisionEvent(*bullet);
 }
 
 void EventsHistory::RevertEvent(std::shared_ptr<EventData<Remove<Wall>>> event)
 {
   World& world = World::Get();
-  for (auto& bullet : world.GetManager<BulletManager>()->WallAdded(world.Walls.Add(event->Data.Value)))
+  for (auto& bullet : world.GetManager<BulletManager>()->WallAdded(world.AddWall(event->Data.Value)))
     ScheduleCollisionEvent(*bullet);
 }
 
@@ -293,11 +1163,14 @@ void EventsHistory::RevertEvent(std::shared_ptr<EventData<Update<Wall>>> event)
 {
   World& world = World::Get();
 
-  Wall* wall = world.Walls.Get(event->Data.New.ID);
+  BulletManager* bullet_manager = world.GetManager<BulletManager>();
 
-  for(auto& bullet: world.GetManager<BulletManager>()->WallAdded(wall
-    ? (*wall = event->Data.Old)
-    : world.Walls.Add(event->Data.Old)))
+  const Wall& wall = world.AddWall(event->Data.Old);
+
+  Set<Bullet*> bullets = bullet_manager->WallRemoved(wall.ID);
+  bullets += bullet_manager->WallAdded(wall);
+
+  for(auto& bullet: bullets)
   {
     ScheduleCollisionEvent(*bullet);
   }
@@ -308,39 +1181,86 @@ void EventsHistory::RevertEvent(std::shared_ptr<EventData<Collision>> event)
   // this never happends
 }
 
-void EventsHistory::ScheduleCollisionEvent(const Bullet& bullet)
+void EventsHistory::RevertEvent(std::shared_ptr<EventData<Horizon>>)
+{
+  // not logged either
+}
+
+void EventsHistory::RevertEvent(std::shared_ptr<EventData<CellCrossing>>)
+{
+  // not logged either
+}
+
+void EventsHistory::ScheduleCollisionEvent(Bullet& bullet)
 {
-  if (!bullet.Collision.Hits) return;
+  if (Replaying) return;
+
+  CancelCollisionEvent(bullet.ID);
+
+  const uint32_t generation = bullet.Collision.Generation = ++CollisionGeneration;
+
+  const tick_t time = bullet.Collision.Hits ? bullet.Collision.Time : bullet.Collision.HorizonTime;
+
+  if (time == Ticks::Infinity) return;
 
-  if (isinf(bullet.Collision.Time)) return;
-  
   World& world = World::Get();
-  
-  double time = bullet.Collision.Time;
 
-  if (time < world.CurrentTime) return;
+  if (time < world.CurrentTick) return;
+
+  std::shared_ptr<Event> event;
+  if (bullet.Collision.Hits)
+    event = MakeEvent<EventsHistory::Collision>(time, EventsHistory::Collision(bullet.ID, generation, bullet.Collision.WallIDs));
+  else if (Config::EnableCellTraversal)
+    event = MakeEvent<EventsHistory::CellCrossing>(time, EventsHistory::CellCrossing(bullet.ID, generation));
+  else
+    event = MakeEvent<EventsHistory::Horizon>(time, EventsHistory::Horizon(bullet.ID, generation));
   
-  ScheduleEvent<EventsHistory::Collision>(time, { bullet.ID, bullet.Collision.WallIDs });
+  ScheduleEvent(event);
+
+  CollisionEvents[bullet.ID] = event;
+}
+
+bool EventsHistory::IsCollisionEventLive(const Bullet* bullet, uint32_t generation)
+{
+  if (bullet && bullet->Collision.Generation == generation) return true;
+
+  ++StaleCollisionEvents;
+  return false;
+}
+
+void EventsHistory::CancelCollisionEvent(uint32_t bullet_id)
+{
+  auto iter = CollisionEvents.find(bullet_id);
+
+  if (iter == CollisionEvents.end()) return;
+
+  // a fired event is gone from the queue already
+  if (std::shared_ptr<Event> event = iter->second.lock())
+    EventsQueue.Remove(event);
+
+  CollisionEvents.erase(iter);
 }
 
 void EventsHistory::Clear()
 {
   EventsLog.clear();
+  BulletEvents.clear();
+  WallEvents.clear();
+  BounceEvents.clear();
+  Spill.clear();
+  LogBytes = 0;
+  Keyframes.clear();
+  KeyframeEventCount = 0;
+  EvictedTime = -Ticks::Infinity;
   EventsQueue.clear();
+  PendingCollisionUpdates.clear();
+  CollisionEvents.clear();
+  StaleCollisionEvents = 0;
+  ProcessedEvents = 0;
+  PeakQueueSize = 0;
 }
 
-double EventsHistory::GetLastCollisionTime()
+tick_t EventsHistory::GetLastCollisionTime() const
 {
-  if (!EventsLog.size()) return std::numeric_limits<double>::max();
-
-  for (auto event : EventsLog)
-  {
-    auto collision_event = std::dynamic_pointer_cast<EventsHistory::EventData<Collision>>(event);
-    if (collision_event)
-    {
-      return collision_event->Time;
-    }
-  }
-
-  return std::numeric_limits<double>::max();
+  return BounceEvents.size() ? BounceEvents.First()->Time : Ticks::Infinity;
 }
@@ -1,10 +1,19 @@
 #pragma once
 
+#include "Map.h"
 #include "Set.h"
+#include "Tick.h"
 #include "Types.h"
+#include "Keyframe.h"
+#include "InlineSet.h"
+#include "EventScheduler.h"
+#include "MappedRingFile.h"
+#include "SlabAllocator.h"
 
 #include <atomic>
+#include <limits>
 #include <memory>
+#include <unordered_map>
 
 
 struct Wall;
@@ -17,39 +26,56 @@ struct EventsHistory
     ET_ADD,
     ET_REMOVE,
     ET_UPDATE,
-    ET_COLLISION
+    ET_COLLISION,
+    ET_HORIZON,
+    ET_CELL_CROSSING,
+    ET_BOUNCE
   };
 
+  // operation and entity of an event, selects its handler without RTTI
+  enum EventTag : uint8_t
+  {
+    TAG_ADD_BULLET,
+    TAG_REMOVE_BULLET,
+    TAG_UPDATE_BULLET,
+    TAG_ADD_WALL,
+    TAG_REMOVE_WALL,
+    TAG_UPDATE_WALL,
+    TAG_COLLISION,
+    TAG_HORIZON,
+    TAG_CELL_CROSSING,
+    TAG_BOUNCE
+  };
+
+  // tags of Add, Remove and Update of an entity type, specialized below
+  template<typename T>
+  struct EntityTags;
+
   class Event
   {
   public:
 
     uint64_t ID;
-    double Time;
+    tick_t Time;
 
     EventType Type;
+    EventTag Tag;
     bool Persistant = false;
 
+    // the event and the heap memory its payload holds
     size_t Size;
 
-    Event(double time, EventType type, size_t size, bool persistant = false) :
-      Time(time), Type(type), Size(size), Persistant(persistant)
+    // set by EventQueue while the event is queued
+    uint64_t QueueTicket = 0;
+
+    Event(tick_t time, EventType type, EventTag tag, size_t size, bool persistant = false) :
+      Time(time), Type(type), Tag(tag), Persistant(persistant), Size(size)
     {
       static std::atomic<uint64_t> EventId = 0;
       ID = EventId++;
-
-      GetTotalEventsSizeRef() += Size;
     }
 
-    static uint64_t GetTotalEventsSize()
-    {
-      return GetTotalEventsSizeRef();
-    }
-
-    virtual ~Event()
-    {
-      GetTotalEventsSizeRef() -= Size;
-    }
+    virtual ~Event() {}
 
     virtual bool operator < (const Event& other) const
     {
@@ -57,20 +83,13 @@ struct EventsHistory
         ? ID < other.ID
         : Time < other.Time;
     }
-
-  private:
-
-    static std::atomic<uint64_t>& GetTotalEventsSizeRef()
-    {
-      static std::atomic<uint64_t> total_events_size = 0;
-      return total_events_size;
-    }
   };
 
   template<typename T>
   struct Add
   {
     static const EventType TYPE = ET_ADD;
+    static const EventTag TAG = EntityTags<T>::ADD;
     T Value;
     Add() {}
     Add(const T& value) :
@@ -81,6 +100,7 @@ struct EventsHistory
   struct Remove
   {
     static const EventType TYPE = ET_REMOVE;
+    static const EventTag TAG = EntityTags<T>::REMOVE;
     T Value;
     Remove() {}
     Remove(const T& value) :
@@ -91,6 +111,7 @@ struct EventsHistory
   struct Update
   {
     static const EventType TYPE = ET_UPDATE;
+    static const EventTag TAG = EntityTags<T>::UPDATE;
     T Old;
     T New;
     Update() {}
@@ -98,42 +119,149 @@ struct EventsHistory
       Old(old), New(new_) {}
   };
 
+  // two ids fit in the space of the pointer to more of them
+  typedef InlineSet<uint32_t, 2> WallSet;
+
+  // search events carry the Bullet::Collision.Generation they were scheduled for
   struct Collision
   {
     static const EventType TYPE = ET_COLLISION;
+    static const EventTag TAG = TAG_COLLISION;
+    uint32_t BulletID;
+    uint32_t Generation;
+    WallSet WallIDs;
+    Collision(uint32_t bulletID, uint32_t generation, const Set<uint32_t>& wallIDs):
+      BulletID(bulletID), Generation(generation), WallIDs(wallIDs)
+    {}
+  };
+
+  // bullet reached the end of its last collision search without hitting anything
+  struct Horizon
+  {
+    static const EventType TYPE = ET_HORIZON;
+    static const EventTag TAG = TAG_HORIZON;
     uint32_t BulletID;
-    Set<uint32_t> WallIDs;
-    Collision(uint32_t bulletID, const Set<uint32_t>& wallIDs):
-      BulletID(bulletID), WallIDs(wallIDs)
+    uint32_t Generation;
+    Horizon(uint32_t bulletID, uint32_t generation) :
+      BulletID(bulletID), Generation(generation)
     {}
   };
 
+  // bullet leaves the grid cell it was searched in, see Config::EnableCellTraversal
+  struct CellCrossing
+  {
+    static const EventType TYPE = ET_CELL_CROSSING;
+    static const EventTag TAG = TAG_CELL_CROSSING;
+    uint32_t BulletID;
+    uint32_t Generation;
+    CellCrossing(uint32_t bulletID, uint32_t generation) :
+      BulletID(bulletID), Generation(generation)
+    {}
+  };
+
+  // bullet bounced off walls, an Update<Bullet> holding only what a bounce changes.
+  // the state before it is the one after it with the applied hit restored
+  struct Bounce
+  {
+    static const EventType TYPE = ET_BOUNCE;
+    static const EventTag TAG = TAG_BOUNCE;
+
+    uint32_t BulletID;
+
+    // before, at the event time the bullet is at the old collision location
+    float OldLifetime;
+    tick_t OldTime;
+    float2 OldLocation;
+    float2 OldDirection;
+    float2 OldNormal;
+    WallSet OldWallIDs;
+
+    // after, the bullet is at the event time
+    float2 Location;
+    float2 Direction;
+    float Lifetime;
+
+    bool Hits;
+    tick_t CollisionTime;
+    float2 CollisionLocation;
+    float2 CollisionDirection;
+    float2 CollisionNormal;
+    tick_t HorizonTime;
+    WallSet WallIDs;
+
+    Bounce() {}
+
+    // the new state is filled in by SetNew
+    explicit Bounce(const Bullet& old);
+
+    void SetNew(const Bullet& bullet);
+
+    void GetOld(Bullet& bullet, tick_t time) const;
+    void GetNew(Bullet& bullet, tick_t time) const;
+  };
+
   template<typename T>
-  class EventData : public virtual Event
+  class EventData : public Event
   {
   public:
 
     T Data;
 
-    EventData(double time, const T& Data, bool persistant = false) :
-      Event(time, T::TYPE, sizeof(EventData<T>), persistant), Data(Data)
+    EventData(tick_t time, const T& Data, bool persistant = false) :
+      Event(time, T::TYPE, T::TAG, sizeof(EventData<T>) + GetHeapBytes(Data), persistant), Data(Data)
     {}
 
     virtual ~EventData() {}
   };
 
+  // estimate of the heap memory payloads hold outside the event
+  template<typename T>
+  static size_t GetHeapBytes(const Set<T>& set)
+  {
+    // red-black tree node: three links and the color next to the value
+    return set.size() * (sizeof(T) + 4 * sizeof(void*));
+  }
+  static size_t GetHeapBytes(const Bullet& bullet);
+  static size_t GetHeapBytes(const Wall&) { return 0; }
+  template<typename T>
+  static size_t GetHeapBytes(const Add<T>& data) { return GetHeapBytes(data.Value); }
+  template<typename T>
+  static size_t GetHeapBytes(const Remove<T>& data) { return GetHeapBytes(data.Value); }
+  template<typename T>
+  static size_t GetHeapBytes(const Update<T>& data) { return GetHeapBytes(data.Old) + GetHeapBytes(data.New); }
+  static size_t GetHeapBytes(const Collision& data) { return data.WallIDs.GetHeapBytes(); }
+  static size_t GetHeapBytes(const Horizon&) { return 0; }
+  static size_t GetHeapBytes(const CellCrossing&) { return 0; }
+  static size_t GetHeapBytes(const Bounce& data) { return data.OldWallIDs.GetHeapBytes() + data.WallIDs.GetHeapBytes(); }
+
+  // schedules a Bounce of the bullet when it goes out of scope
+  struct ScopedBounce
+  {
+    EventsHistory& History;
+
+    tick_t Time;
+
+    const Bullet& Target;
+
+    Bounce Data;
+
+    ScopedBounce(EventsHistory& History, tick_t time, const Bullet& target);
+
+    ~ScopedBounce();
+  };
+
   template<typename T, template<class> typename E = Update>
   struct ScopedUpdate
   {
     EventsHistory& History;
 
-    double Time;
+    tick_t Time;
 
     const T& Target;
 
     T InitialValue;
 
-    ScopedUpdate(EventsHistory& History, double time, const T& target) :
+    ScopedUpdate(EventsHistory& History, tick_t time, const T& target) :
       History(History),
       Time(time),
       Target(target),
@@ -154,7 +282,7 @@ struct EventsHistory
     {
       static struct {
         Cmp<uint64_t> id;
-        Cmp<double> time;
+        Cmp<tick_t> time;
       } cmp;
       if (_Left->Time == _Right->Time)
         return cmp.id(_Left->ID, _Right->ID);
@@ -164,28 +292,115 @@ struct EventsHistory
 
 public:
 
-  Set<std::shared_ptr<Event>, EventsCompare<std::greater>> EventsLog;
+  typedef Set<std::shared_ptr<Event>, EventsCompare<std::greater>> EventsLogSet;
+
+  EventsLogSet EventsLog;
+
+  // logged events of each bullet and wall and the logged bounces, latest first.
+  // kept in step with EventsLog by LogEvent and UnlogEvent
+  std::unordered_map<uint32_t, EventsLogSet> BulletEvents;
+  std::unordered_map<uint32_t, EventsLogSet> WallEvents;
+  EventsLogSet BounceEvents;
+
+  // sum of Size over EventsLog and Keyframes and of the index entries, bounded by Config::HistoryMaxBytes
+  uint64_t LogBytes = 0;
+
+  // world snapshots taken between the logged events, oldest first.
+  // a long rewind restores one and replays the events logged after it
+  Array<Keyframe> Keyframes;
+
+  // events logged since the last keyframe
+  size_t KeyframeEventCount = 0;
+
+  // latest time of an event dropped from the log, keyframes before it can't be replayed from
+  tick_t EvictedTime = -Ticks::Infinity;
+
+  // keyframe replay doesn't schedule collision events, they are rebuilt once it's done
+  bool Replaying = false;
 
-  Set<std::shared_ptr<Event>, EventsCompare<std::less>> EventsQueue;
+  // events aged out of EventsLog, serialized oldest first, see Config::HistorySpillBytes
+  MappedRingFile Spill;
+
+  EventScheduler<Event> EventsQueue;
 
   const float MaxAge = 60.0; // seconds
 
+  // bullets restored during a rewind whose collisions are computed when it ends, by bullet id
+  Map<uint32_t, tick_t> PendingCollisionUpdates;
+
+  // latest Collision, Horizon or CellCrossing event scheduled for each bullet, by bullet id
+  std::unordered_map<uint32_t, std::weak_ptr<Event>> CollisionEvents;
+
+  // last Bullet::Collision.Generation handed out
+  uint32_t CollisionGeneration = 0;
+
+  // search events popped after being superseded, cancelling keeps this near zero
+  size_t StaleCollisionEvents = 0;
+
+  // events taken off the queue and applied, stale ones included
+  size_t ProcessedEvents = 0;
+
+  // most events queued at once, sampled while the queue is processed
+  size_t PeakQueueSize = 0;
+
 public:
 
+  // bytes held by the event pools, payload members that allocate on their own are not included
   uint64_t GetTotalSize() const;
 
+  // bytes of the logged events and keyframes
+  uint64_t GetLogSize() const
+  {
+    return LogBytes;
+  }
+
+  // earliest time the world can be rewound to
+  tick_t GetRewindHorizon() const;
+
+  void LogEvent(std::shared_ptr<Event> event);
+
+  // to be called for each event taken out of EventsLog
+  void UnlogEvent(const std::shared_ptr<Event>& event);
+
+  // opens or closes the spill file to match the config
+  void UpdateSpill();
+
+  void SpillEvent(const std::shared_ptr<Event>& event);
+
+  // brings the spilled events from the time on back into EventsLog
+  void UnspillEvents(tick_t time);
+
+  // logged events of the bullet or wall latest first, nullptr if it has none
+  const EventsLogSet* GetBulletEvents(uint32_t bullet_id) const;
+  const EventsLogSet* GetWallEvents(uint32_t wall_id) const;
+
+  std::shared_ptr<Event> GetLastBulletEvent(uint32_t bullet_id) const;
+
+  // bullet or wall the event is about
+  static uint32_t GetEntityID(const std::shared_ptr<Event>& event);
+  static bool IsWallEvent(const std::shared_ptr<Event>& event);
+
+  static const char* GetTagName(EventTag tag);
+
   void ScheduleEvent(std::shared_ptr<Event> event);
 
+  // events and their control blocks come from a slab pool per event type
+  template<typename T>
+  static std::shared_ptr<EventData<T>> MakeEvent(tick_t time, const T& Data, const bool persistant = false)
+  {
+    return std::allocate_shared<EventData<T>>(SlabAllocator<EventData<T>>(), time, Data, persistant);
+  }
+
   template<typename T>
-  void ScheduleEvent(double time, const T& Data, const bool persistant = false)
+  void ScheduleEvent(tick_t time, const T& Data, const bool persistant = false)
   {
-    return ScheduleEvent(std::make_shared<EventData<T>>(time, Data, persistant));
+    return ScheduleEvent(MakeEvent<T>(time, Data, persistant));
   }
 
   template<typename T>
-  void ScheduleEvent(double time, const T* Data, const bool persistant = false)
+  void ScheduleEvent(tick_t time, const T* Data, const bool persistant = false)
   {
-    return ScheduleEvent(std::make_shared<EventData<T>>(time, *Data, persistant));
+    return ScheduleEvent(MakeEvent<T>(time, *Data, persistant));
   }
 
   template<typename T>
@@ -194,12 +409,19 @@ public:
     return sizeof(EventData<T>);
   }
 
+  // the event if its payload is T, nullptr otherwise
+  template<typename T>
+  static inline std::shared_ptr<EventData<T>> Cast(const std::shared_ptr<Event>& event)
+  {
+    if (!event || event->Tag != T::TAG) return nullptr;
+    return std::static_pointer_cast<EventData<T>>(event);
+  }
+
+  // the tag has been checked by the caller
   template<typename T, typename BaseT>
   inline bool ApplyEventCastAndCall(std::shared_ptr<BaseT> event)
   {
-    std::shared_ptr<EventData<T>> ptr = std::dynamic_pointer_cast<EventData<T>>(event);
-    if (!ptr) return false;    
-    return ApplyEvent(ptr);
+    return ApplyEvent(std::static_pointer_cast<EventData<T>>(event));
   }    
   bool ApplyEvent(std::shared_ptr<Event> event);
   bool ApplyEvent(std::shared_ptr<EventData<Add<Bullet>>> event);
@@ -209,13 +431,14 @@ public:
   bool ApplyEvent(std::shared_ptr<EventData<Remove<Wall>>> event);
   bool ApplyEvent(std::shared_ptr<EventData<Update<Wall>>> event);
   bool ApplyEvent(std::shared_ptr<EventData<Collision>> event);
+  bool ApplyEvent(std::shared_ptr<EventData<Horizon>> event);
+  bool ApplyEvent(std::shared_ptr<EventData<CellCrossing>> event);
+  bool ApplyEvent(std::shared_ptr<EventData<Bounce>> event);
 
   template<typename T, typename BaseT>
   bool RevertEventCastAndCall(std::shared_ptr<BaseT> event)
   {
-    std::shared_ptr<T> ptr = std::dynamic_pointer_cast<T>(event);
-    if (!ptr) return false;
-    RevertEvent(ptr);
+    RevertEvent(std::static_pointer_cast<T>(event));
     return true;
   }
   void RevertEvent(std::shared_ptr<Event> event);
@@ -226,25 +449,58 @@ public:
   void RevertEvent(std::shared_ptr<EventData<Remove<Wall>>> event);
   void RevertEvent(std::shared_ptr<EventData<Update<Wall>>> event);
   void RevertEvent(std::shared_ptr<EventData<Collision>> event);
+  void RevertEvent(std::shared_ptr<EventData<Horizon>> event);
+  void RevertEvent(std::shared_ptr<EventData<CellCrossing>> event);
+  void RevertEvent(std::shared_ptr<EventData<Bounce>> event);
   
-  void Rewind(double time);
-  bool ProcessEventsQueueSingle(double time);
-  void ProcessEventsQueue(double time);
+  void Rewind(tick_t time);
+  void RewindToKeyframe(size_t keyframe_index, tick_t time);
+  void ReplayEvent(std::shared_ptr<Event> event);
+
+  // takes a keyframe once replaying the events since the last one costs more than restoring it
+  void UpdateKeyframes();
+  bool ProcessEventsQueueSingle(tick_t time);
+  void ProcessEventsQueue(tick_t time);
+  bool ProcessAddBulletEvents(tick_t time);
+  void UpdatePendingCollisions();
     
   void Cleanup();
 
   void Clear();
 
-  std::shared_ptr<Event> GetNextEvent(double max_time = std::numeric_limits<double>::infinity(), bool remove = false);
+  std::shared_ptr<Event> GetNextEvent(tick_t max_time = Ticks::Infinity, bool remove = false);
 
-  std::shared_ptr<Event> PopNextEvent(double max_time = std::numeric_limits<double>::infinity())
+  std::shared_ptr<Event> PopNextEvent(tick_t max_time = Ticks::Infinity)
   {
     return GetNextEvent(max_time, true);
   }
   
-  void ScheduleCollisionEvent(const Bullet& bullet);
+  // replaces the bullet's queued Collision, Horizon or CellCrossing event
+  void ScheduleCollisionEvent(Bullet& bullet);
+
+  // true if the event is the bullet's latest search event, counts it as stale otherwise
+  bool IsCollisionEventLive(const Bullet* bullet, uint32_t generation);
+
+  void CancelCollisionEvent(uint32_t bullet_id);
 
-  double GetLastCollisionTime();
+  // time of the latest logged bounce, Ticks::Infinity if there is none
+  tick_t GetLastCollisionTime() const;
+};
+
+template<>
+struct EventsHistory::EntityTags<Bullet>
+{
+  static const EventTag ADD = TAG_ADD_BULLET;
+  static const EventTag REMOVE = TAG_REMOVE_BULLET;
+  static const EventTag UPDATE = TAG_UPDATE_BULLET;
+};
+
+template<>
+struct EventsHistory::EntityTags<Wall>
+{
+  static const EventTag ADD = TAG_ADD_WALL;
+  static const EventTag REMOVE = TAG_REMOVE_WALL;
+  static const EventTag UPDATE = TAG_UPDATE_WALL;
 };
 
 extern std::ostream& operator<<(std::ostream& stream, const EventsHistory::Event& event);
@@ -0,0 +1,95 @@
+#include "Common.h"
+
+#include "Math.h"
+#include "World.h"
+#include "Config.h"
+#include "Scenario.h"
+#include "StringUtils.h"
+#include "BulletManager.h"
+
+#include <chrono>
+#include <string>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+
+// simulation without a window: a scenario advanced in fixed steps, for servers
+struct HeadlessOptions
+{
+  Scenario::Type Type = Scenario::RANDOM_WALLS;
+  double Seconds = 10.0;
+  double Step = 1.0 / 60.0;
+  size_t Bullets = 1000;
+  size_t Walls = 100;
+  unsigned Seed = 1;
+};
+
+static void PrintUsage(const char* binary)
+{
+  std::cout << "usage: " << binary << " [--scenario NAME] [--seconds S] [--step S] [--bullets N] [--walls N] [--seed N]\n";
+}
+
+static bool ParseOptions(int argc, char** argv, HeadlessOptions& options)
+{
+  for (int i = 1; i < argc; ++i)
+  {
+    if (i + 1 >= argc) return false;
+
+    const char* name = argv[i];
+    const char* value = argv[++i];
+
+    if (!strcmp(name, "--scenario")) { if (!Scenario::FindType(value, options.Type)) return false; }
+    else if (!strcmp(name, "--seconds")) options.Seconds = atof(value);
+    else if (!strcmp(name, "--step")) options.Step = atof(value);
+    else if (!strcmp(name, "--bullets")) options.Bullets = strtoull(value, nullptr, 10);
+    else if (!strcmp(name, "--walls")) options.Walls = strtoull(value, nullptr, 10);
+    else if (!strcmp(name, "--seed")) options.Seed = unsigned(strtoul(value, nullptr, 10));
+    else return false;
+  }
+
+  return options.Step > 0 && options.Seconds >= 0;
+}
+
+int main(int argc, char** argv)
+{
+  Config::BinaryPath = argv[0];
+
+  HeadlessOptions options;
+  if (!ParseOptions(argc, argv, options))
+  {
+    PrintUsage(argv[0]);
+    return 1;
+  }
+
+  World world;
+
+  BulletManager* bullet_manager = new BulletManager();
+  world.Managers += bullet_manager;
+
+  Scenario scenario(options.Type, options.Seed, options.Bullets, options.Walls);
+  Config::DestroyWallsOnCollision = scenario.DestroysWalls();
+  scenario.Build(world);
+
+  const auto start_time = std::chrono::steady_clock::now();
+
+  const tick_t step_ticks = Max(Ticks::FromSeconds(options.Step), tick_t(1));
+  const tick_t end_time = Ticks::FromSeconds(options.Seconds);
+  const size_t steps = size_t((end_time + step_ticks - 1) / step_ticks);
+
+  for (size_t step = 1; step <= steps; ++step)
+  {
+    world.Simulate(Min(tick_t(step) * step_ticks, end_time));
+    scenario.Update(world);
+  }
+
+  const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+
+  std::cout << Scenario::GetName(options.Type) << ": simulated " << options.Seconds << " s in " << steps << " steps, " << elapsed << " s wall clock\n";
+  std::cout << "bullets: " << world.Bullets.size() << ", walls: " << world.Walls.size() << "\n";
+  std::cout << "past events: " << world.History.EventsLog.size()
+    << ", history: " << String::FormatBytes(world.History.GetLogSize())
+    << ", event pools: " << String::FormatBytes(world.History.GetTotalSize()) << "\n";
+
+  return 0;
+}
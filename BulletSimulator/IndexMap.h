@@ -35,8 +35,8 @@ public:
     return true;
   }
 
-  template<typename T>
-  void Convert(T iter)
+  template<typename Iter>
+  void Convert(Iter iter)
   {
     for (auto& pair : *this)
       *(iter++) = pair.second;
@@ -0,0 +1,115 @@
+#pragma once
+
+#include "Set.h"
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+
+// sorted set of trivially copyable values kept inside the object while there are at most N of them.
+// read only once built, meant for compact copies of small Sets such as the walls of a hit
+template<typename T, size_t N>
+class InlineSet
+{
+  static_assert(std::is_trivially_copyable<T>::value, "InlineSet holds plain values");
+
+public:
+
+  InlineSet() {}
+
+  InlineSet(const Set<T>& set)
+  {
+    Assign(set.begin(), set.size());
+  }
+
+  InlineSet(const InlineSet& other)
+  {
+    Assign(other.begin(), other.Count);
+  }
+
+  InlineSet(InlineSet&& other) noexcept :
+    Count(other.Count)
+  {
+    std::memcpy(&Storage, &other.Storage, sizeof(Storage));
+    other.Count = 0;
+  }
+
+  InlineSet& operator=(const InlineSet& other)
+  {
+    if (this == &other) return *this;
+    Free();
+    Assign(other.begin(), other.Count);
+    return *this;
+  }
+
+  ~InlineSet()
+  {
+    Free();
+  }
+
+  size_t size() const
+  {
+    return Count;
+  }
+
+  const T* begin() const
+  {
+    return IsInline() ? Storage.Items : Storage.Heap;
+  }
+
+  const T* end() const
+  {
+    return begin() + Count;
+  }
+
+  // allocated outside the object, 0 unless more than N values are held
+  size_t GetHeapBytes() const
+  {
+    return IsInline() ? 0 : Count * sizeof(T);
+  }
+
+  Set<T> ToSet() const
+  {
+    return Set<T>(begin(), end());
+  }
+
+  bool operator==(const Set<T>& set) const
+  {
+    if (set.size() != Count) return false;
+    const T* value = begin();
+    for (const T& other : set)
+      if (!(*value++ == other)) return false;
+    return true;
+  }
+
+private:
+
+  uint32_t Count = 0;
+
+  union
+  {
+    T Items[N];
+    T* Heap;
+  } Storage;
+
+  bool IsInline() const
+  {
+    return Count <= N;
+  }
+
+  template<typename Iter>
+  void Assign(Iter first, size_t count)
+  {
+    Count = uint32_t(count);
+    T* values = IsInline() ? Storage.Items : (Storage.Heap = new T[count]);
+    for (size_t i = 0; i < count; ++i, ++first)
+      values[i] = *first;
+  }
+
+  void Free()
+  {
+    if (!IsInline()) delete[] Storage.Heap;
+    Count = 0;
+  }
+};
@@ -147,7 +147,7 @@ void InputManager::Update(double delta_time)
       double pressed_time;
       if (IsKeyPressed(pair.first.Button, &pressed_time))
       {
-        double pressed_seconds = World::Get().CurrentTime - pressed_time;
+        double pressed_seconds = World::Get().GetSeconds() - pressed_time;
         double update_time = std::min(double(delta_time), pressed_seconds);
 
         axis_values[pair.second.Axis] += (pair.second.InvertAxis ? -1 : 1) * update_time / double(delta_time);
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "Wall.h"
+#include "Array.h"
+#include "Bullet.h"
+
+#include <cstddef>
+
+
+// copy of the world with every event up to and including Time applied
+struct Keyframe
+{
+  tick_t Time = 0;
+
+  Array<Bullet> Bullets;
+  Array<Wall> Walls;
+
+  // bytes held, counted against Config::HistoryMaxBytes
+  size_t Size = 0;
+
+  // events logged after this keyframe when the next one was taken
+  size_t EventCount = 0;
+};
@@ -1,17 +1,16 @@
 #include "Common.h"
 
-#include "Color.h"
 #include "World.h"
 #include "Logger.h"
+#include "Manager.h"
 #include "MessageStream.h"
-#include "ConsoleManager.h"
 
 #ifdef _MSVC_LANG
 #include <Windows.h>
-#else
-#include <iostream>
 #endif
 
+#include <iostream>
+
 
 Logger::~Logger()
 {
@@ -23,7 +22,20 @@ Logger::~Logger()
 #endif
 }
 
-MessageStream GetConsoleLogStream(const Color& color, double max_age)
+class StandardOutputSink: public MessageSink
 {
-  return World::Get().GetManager<ConsoleManager>()->GetStream(color, max_age);
+public:
+
+  void WriteMessage(const std::string& message, const LogColor& color, double max_age) override
+  {
+    std::cout << message << "\n";
+  }
+};
+
+MessageStream GetConsoleLogStream(const LogColor& color, double max_age)
+{
+  static StandardOutputSink standard_output;
+
+  MessageSink* sink = World::Get().GetManager<MessageSink>();
+  return MessageStream(sink ? *sink : standard_output, color, max_age);
 }
@@ -2,10 +2,12 @@
 
 #include "MessageStream.h"
 
+#include <cstring>
 #include <sstream>
 
 
-extern MessageStream GetConsoleLogStream(const struct Color& color, double max_age);
+// stream into the first MessageSink manager of the world, the standard output without one
+extern MessageStream GetConsoleLogStream(const LogColor& color, double max_age);
 
 class Logger
 {
@@ -33,12 +35,12 @@ public:
 
 #define LOG_COUT (Logger() << __FILENAME__ << ":" << __LINE__ << ": ")
 
-#define LOG GetConsoleLogStream({ 0, 0xFF, 0xFF, 0xFF }, 5.0)
+#define LOG GetConsoleLogStream(LogColor(0, 0xFF, 0xFF), 5.0)
 #define LOG__(color, max_age) GetConsoleLogStream(color, max_age)
 #define LOG_(color) LOG__(color, 5.0)
 
-#define COLOR_GREY(L) { L, L, L, 0xFF }
-#define COLOR(R, G, B) { R, G, B, 0xFF }
+#define COLOR_GREY(L) LogColor(L, L, L)
+#define COLOR(R, G, B) LogColor(R, G, B)
 
 #define COLOR_LOG_DEFAULT COLOR(0x0, 0xFF, 0xFF)
 #define COLOR_LOG_ERROR COLOR(0xFF, 0x62, 0x4C)
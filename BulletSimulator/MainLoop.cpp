@@ -66,11 +66,11 @@ bool MainLoop(World& world, SDL_Renderer* renderer, double delta_time)
 
   if (Config::ReverseTime)
   {
-    world.Rewind(world.CurrentTime - delta_time);
+    world.Rewind(world.CurrentTick - Ticks::FromSeconds(delta_time));
   }
   else
   {
-    world.Simulate(world.CurrentTime + delta_time);
+    world.Simulate(world.CurrentTick + Ticks::FromSeconds(delta_time));
   }
   auto sim_end_time = std::chrono::system_clock::now();
   auto sim_duration_ns = double(std::chrono::duration_cast<std::chrono::nanoseconds>(sim_end_time - sim_start_time).count());
@@ -0,0 +1,141 @@
+#include "Common.h"
+
+#include "MappedRingFile.h"
+
+#include <cstring>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+
+
+bool MappedRingFile::Open(const std::string& path, size_t capacity)
+{
+  Close();
+
+  if (!capacity) return false;
+
+#ifdef _WIN32
+  HANDLE file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_TEMPORARY, nullptr);
+  if (file == INVALID_HANDLE_VALUE) return false;
+
+  HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READWRITE, DWORD(uint64_t(capacity) >> 32), DWORD(capacity), nullptr);
+  if (!mapping)
+  {
+    CloseHandle(file);
+    return false;
+  }
+
+  void* data = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, capacity);
+  if (!data)
+  {
+    CloseHandle(mapping);
+    CloseHandle(file);
+    return false;
+  }
+
+  File = file;
+  Mapping = mapping;
+#else
+  int file = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (file < 0) return false;
+
+  if (::ftruncate(file, off_t(capacity)) != 0)
+  {
+    ::close(file);
+    return false;
+  }
+
+  void* data = ::mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+  if (data == MAP_FAILED)
+  {
+    ::close(file);
+    return false;
+  }
+
+  File = file;
+#endif
+
+  Data = static_cast<uint8_t*>(data);
+  Capacity = capacity;
+
+  return true;
+}
+
+void MappedRingFile::Close()
+{
+  clear();
+
+  if (!Data) return;
+
+#ifdef _WIN32
+  UnmapViewOfFile(Data);
+  CloseHandle(Mapping);
+  CloseHandle(File);
+  Mapping = nullptr;
+  File = nullptr;
+#else
+  ::munmap(Data, Capacity);
+  ::close(File);
+  File = -1;
+#endif
+
+  Data = nullptr;
+  Capacity = 0;
+}
+
+void MappedRingFile::clear()
+{
+  Records.clear();
+  WriteOffset = 0;
+  UsedBytes = 0;
+}
+
+bool MappedRingFile::Push(tick_t time, const uint8_t* bytes, size_t count)
+{
+  if (!Data || count > Capacity) return false;
+
+  // the tail too short for the record is skipped, the records in it are the oldest
+  const bool wraps = WriteOffset + count > Capacity;
+  const size_t skipped_from = WriteOffset;
+
+  if (wraps) WriteOffset = 0;
+
+  while (Records.size())
+  {
+    const Record& oldest = Records.front();
+
+    const bool skipped = wraps && oldest.Offset >= skipped_from;
+    const bool overlaps = oldest.Offset < WriteOffset + count && oldest.Offset + oldest.Bytes > WriteOffset;
+
+    if (!skipped && !overlaps) break;
+
+    UsedBytes -= oldest.Bytes;
+    Records.pop_front();
+  }
+
+  std::memcpy(Data + WriteOffset, bytes, count);
+
+  Records.push_back({ WriteOffset, uint32_t(count), time });
+  WriteOffset += count;
+  UsedBytes += count;
+
+  return true;
+}
+
+const uint8_t* MappedRingFile::GetBack(size_t& count) const
+{
+  count = Records.back().Bytes;
+  return Data + Records.back().Offset;
+}
+
+void MappedRingFile::PopBack()
+{
+  WriteOffset = Records.back().Offset;
+  UsedBytes -= Records.back().Bytes;
+  Records.pop_back();
+}
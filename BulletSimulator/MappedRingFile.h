@@ -0,0 +1,99 @@
+#pragma once
+
+#include "Tick.h"
+
+#include <deque>
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+
+// append-only ring of byte records in a memory-mapped file of a fixed size.
+// records go in time order, a record that doesn't fit overwrites the oldest ones.
+// only the offsets and times of the records are kept in memory
+class MappedRingFile
+{
+public:
+
+  MappedRingFile() {}
+
+  MappedRingFile(const MappedRingFile&) = delete;
+  MappedRingFile& operator=(const MappedRingFile&) = delete;
+
+  ~MappedRingFile()
+  {
+    Close();
+  }
+
+  // creates or truncates the file, false if it can't be mapped
+  bool Open(const std::string& path, size_t capacity);
+
+  void Close();
+
+  bool IsOpen() const
+  {
+    return Data != nullptr;
+  }
+
+  size_t GetCapacity() const
+  {
+    return Capacity;
+  }
+
+  // bytes of the records held
+  size_t GetUsedBytes() const
+  {
+    return UsedBytes;
+  }
+
+  size_t size() const
+  {
+    return Records.size();
+  }
+
+  void clear();
+
+  // false if the record is larger than the file
+  bool Push(tick_t time, const uint8_t* bytes, size_t count);
+
+  // newest record, valid until the next Push
+  const uint8_t* GetBack(size_t& count) const;
+
+  void PopBack();
+
+  tick_t GetFrontTime() const
+  {
+    return Records.front().Time;
+  }
+
+  tick_t GetBackTime() const
+  {
+    return Records.back().Time;
+  }
+
+private:
+
+  struct Record
+  {
+    size_t Offset;
+    uint32_t Bytes;
+    tick_t Time;
+  };
+
+  std::deque<Record> Records;
+
+  uint8_t* Data = nullptr;
+
+  size_t Capacity = 0;
+
+  size_t WriteOffset = 0;
+
+  size_t UsedBytes = 0;
+
+#ifdef _WIN32
+  void* File = nullptr;
+  void* Mapping = nullptr;
+#else
+  int File = -1;
+#endif
+};
@@ -10,15 +10,15 @@ float Floor(const float& value)
 
 double Floor(const double& value)
 {
-  return std::floorl(value);
+  return std::floor(value);
 }
 
 float Ceil(const float& value)
 {
-  return std::ceilf(value);
+  return std::ceil(value);
 }
 
 double Ceil(const double& value)
 {
-  return std::ceill(value);
+  return std::ceil(value);
 }
@@ -8,6 +8,9 @@
 #include "Logger.h"
 #include "LineSegment.h"
 
+#include <cmath>
+#include <limits>
+
 
 bool Math2D::IntersectLineSegments(
   const float2& p0, const float2& p1,
@@ -121,7 +124,7 @@ bool Math2D::PointLineIntersection(const LineSegment& line, const float2& point,
 
   if (Abs(distance_to_line) <= Config::BulletRadius)
   {
-    if (isnan(point.x) || isnan(point.y))
+    if (std::isnan(point.x) || std::isnan(point.y))
     {
       LOG_ERROR << "Math2D::PointLineIntersection isnan(point.x)";
       return false;
@@ -157,7 +160,7 @@ bool Math2D::PointLineIntersection(const LineSegment& line, const float2& point,
 
   if (intersection_point) *intersection_point = location;
 
-  if (isnan(location.x))
+  if (std::isnan(location.x))
   {
     LOG_ERROR << "Math2D::PointLineIntersection isnan(location.x)";
     return false;
@@ -191,95 +194,76 @@ bool Math2D::PointLineIntersection(const LineSegment& line, const float2& point,
   return PointLineIntersection(line, point, direction, &intersection_point);
 }
 
-bool Math2D::CirclePointIntersection(const float2& point, const float2& origin, const float2& direction, const float radius, const float range,
+float Math2D::RayCapsuleIntersection(const LineSegment& segment, const float2& origin, const float2& direction, const float radius, const float range,
   float2& location, float2& normal)
 {
-  LineSegment view_line = { origin, origin + direction * range };
+  const float infinity = std::numeric_limits<float>::infinity();
 
-  float distance = Math2D::DistanceFromPointToLine(view_line, point);
+  const float2 edge = segment.B - segment.A;
+  const float length_sq = edge.Dot(edge);
+  const float length = std::sqrt(length_sq);
+  const float inv_length = length > 0 ? 1.0f / length : 0.0f;
 
-  if (distance == 0)
-  {
-    if (origin.DirectionTo(point).Dot(direction) < 0) return false;
-    normal = point.DirectionTo(origin);
-    float distance = point.DistanceTo(origin);
-    if (distance < radius)
-      location = origin;
-    else
-      location = point - direction * (distance - radius);
-    return true;
-  }
+  const float2 segment_normal = float2(-edge.y * inv_length, edge.x * inv_length);
 
-  if (Abs(distance) > radius) return false;
+  // signed distance from the line and its rate of change along the ray
+  const float distance = segment_normal.Dot(origin - segment.A);
+  const float velocity = segment_normal.Dot(direction);
 
-  float2 v = view_line.GetNormal() * distance;
+  // origin exactly on the line counts as being on the side it moves away from
+  const float side = distance != 0 ? distance : -velocity;
 
-  float collision_distance = sqrt(pow(radius, 2.0f) - pow(v.Length(), 2.0f));
+  const bool inside = std::fabs(distance) <= radius;
+  const bool approaching = side * velocity < 0;
 
-  float2 ddir = origin.DirectionTo(point + v);
+  if (!inside && !approaching) return infinity;
 
-  float2 offset = v - ddir * collision_distance;
+  // distance until the circle touches the line
+  const float enter = inside ? 0.0f : (std::fabs(distance) - radius) / std::fabs(velocity);
 
-  location = point + offset;
+  const float projection = (origin + direction * enter - segment.A).Dot(edge);
 
-  normal = point.DirectionTo(location);
+  float t;
 
-  return true;
-}
-
-bool Math2D::CircleLineIntersection(const LineSegment& segment, const float2& origin, const float2& direction, const float radius, const float range, 
-  float2& location, float2& normal)
-{
-  float distance;
-  bool hit = Math2D::PointLineIntersection(segment, origin, direction, location, distance);
-
-  if (hit && isnan(location.x))
+  if (projection >= 0 && projection <= length_sq && length_sq > 0)
   {
-    LOG_ERROR << "Math2D::CircleLineIntersection isnan(location.x)";
-    return false;
-  }
+    if (!approaching) return infinity;
 
-  if (!hit && distance <= Config::BulletRadius && 
-      Max(origin.DistanceTo(segment.A), origin.DistanceTo(segment.B)) <= segment.Length())
-  {
-    return false;
+    t = enter;
+    normal = side < 0 ? -segment_normal : segment_normal;
   }
-
-  float2 location_tmp;
-  float2 normal_tmp;
-  
-  auto check_end = [&](const float2& point) -> bool
+  else
   {
-    if (!Math2D::CirclePointIntersection(point, origin, direction, radius, range, location_tmp, normal_tmp))
-      return false;
-    
-    if (hit && origin.DistanceTo(location_tmp) > origin.DistanceTo(location))
-      return false;
-      
-    if (origin.DirectionTo(location_tmp).Dot(direction) <= 0)
-      return false;
-        
-    location = location_tmp;
-    normal = normal_tmp;
+    // the line is touched past an end, so the end cap is hit first or not at all
+    const float2 cap = projection < 0 ? segment.A : segment.B;
 
-    return hit = true;
-  };
+    const float2 offset = origin - cap;
+    const float b = offset.Dot(direction);
+    const float c = offset.Dot(offset) - radius * radius;
 
-  bool hit_end_A = check_end(segment.A);
-  bool hit_end_B = check_end(segment.B);
+    if (b >= 0) return infinity;
 
-  if (hit_end_A || hit_end_B)
-  {
-    return true;
+    if (c <= 0)
+    {
+      // already overlapping the cap and moving into it
+      t = 0.0f;
+      const float offset_length = std::sqrt(offset.Dot(offset));
+      normal = offset * (offset_length > 0 ? 1.0f / offset_length : 0.0f);
+    }
+    else
+    {
+      const float discriminant = b * b - c;
+      if (discriminant < 0) return infinity;
+      t = -b - std::sqrt(discriminant);
+      normal = (origin + direction * t - cap) * (1.0f / radius);
+    }
   }
 
-  if (hit)
-  {
-    normal = -segment.GetNormal() * Sign(distance);
-    return true;
-  }
+  if (t > range) return infinity;
 
-  return false;
+  location = origin + direction * t;
+
+  return t;
 }
 
 float Math2D::GetAngleRadians(const float2& vector)
@@ -30,8 +30,9 @@ namespace Math2D
   bool PointLineIntersection(const LineSegment& line, const float2& point, const float2& direction, float2& intersection_point, float& intersection_distance);
   bool PointLineIntersection(const LineSegment& line, const float2& point, const float2& direction, float2& intersection_point);
   
-  bool CirclePointIntersection(const float2& point, const float2& origin, const float2& direction, const float radius, const float range, float2& location, float2& normal);
-
-  bool CircleLineIntersection(const LineSegment& segment, const float2& origin, const float2& direction, const float radius, const float range, float2& point, float2& normal);
+  // circle of the radius moving from origin along the unit direction vs the segment inflated by the radius,
+  // returns distance traveled until contact or infinity if it is not reached within range.
+  // location is the circle center at contact, normal points from the wall towards it
+  float RayCapsuleIntersection(const LineSegment& segment, const float2& origin, const float2& direction, const float radius, const float range, float2& location, float2& normal);
 
 }
@@ -2,11 +2,9 @@
 
 #include "MessageStream.h"
 
-#include "ConsoleManager.h"
 
-
-MessageStream::MessageStream(ConsoleManager& manager, const Color& color, double max_age) :
-  Manager(manager),
+MessageStream::MessageStream(MessageSink& sink, const LogColor& color, double max_age) :
+  Sink(sink),
   MessageColor(color),
   MaxAge(max_age)
 {
@@ -17,7 +15,7 @@ MessageStream::MessageStream(ConsoleManager& manager, const Color& color, double
 MessageStream::MessageStream(const MessageStream& other) :
   RefCount(other.RefCount),
   Stream(other.Stream),
-  Manager(other.Manager),
+  Sink(other.Sink),
   MessageColor(other.MessageColor),
   MaxAge(other.MaxAge)
 {
@@ -56,7 +54,7 @@ void MessageStream::DecrementRefCount()
   {
     if (Stream)
     {
-      Manager.AddMessage(reinterpret_cast<std::stringstream*>(Stream)->str(), MessageColor, MaxAge);
+      Sink.WriteMessage(reinterpret_cast<std::stringstream*>(Stream)->str(), MessageColor, MaxAge);
       delete Stream;
       Stream = nullptr;
     }
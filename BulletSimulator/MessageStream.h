@@ -1,11 +1,29 @@
 #pragma once
 
-#include "Color.h"
-
+#include <string>
+#include <cstdint>
 #include <sstream>
 
 
-class ConsoleManager;
+// message color without the SDL one, the console converts it
+struct LogColor
+{
+  uint8_t r, g, b, a;
+
+  constexpr LogColor(uint8_t R, uint8_t G, uint8_t B, uint8_t A = 0xFF) :
+    r(R), g(G), b(B), a(A)
+  {}
+};
+
+// receives the finished messages, the console or the standard output when there's none
+class MessageSink
+{
+public:
+
+  virtual ~MessageSink() {}
+
+  virtual void WriteMessage(const std::string& message, const LogColor& color, double max_age) = 0;
+};
 
 class MessageStream
 {
@@ -13,15 +31,15 @@ class MessageStream
 
   std::stringstream* Stream = nullptr;
 
-  ConsoleManager& Manager;
+  MessageSink& Sink;
 
-  Color MessageColor;
+  LogColor MessageColor;
 
   double MaxAge;
 
 public:
 
-  MessageStream(ConsoleManager& manager, const Color& color = { 0x0, 0xFF, 0xFF, 0xFF }, double max_age = 5.0);
+  MessageStream(MessageSink& sink, const LogColor& color = LogColor(0x0, 0xFF, 0xFF), double max_age = 5.0);
 
   MessageStream(const MessageStream& other);
 
@@ -54,19 +54,19 @@ NetworkClient::NetworkClient(std::mutex& EventQueueMutex,
       {
         world.GetManager<BulletManager>()->UpdateNextWallID(packet->Walls[i].ID);
         this->EventQueue.insert(
-          std::make_shared<EventsHistory::EventData<EventsHistory::Add<Wall>>>(
-            packet->Walls[i].Time.GetTime(packet->Time), packet->Walls[i], true));
+          EventsHistory::MakeEvent<EventsHistory::Add<Wall>>(
+            packet->Walls[i].Time, packet->Walls[i], true));
       }
 
       for (size_t i = 0; i < packet->Header.BulletCount; ++i)
       {
         world.GetManager<BulletManager>()->UpdateNextBulletID(packet->Bullets[i].ID);
         this->EventQueue.insert(
-          std::make_shared<EventsHistory::EventData<EventsHistory::Add<Bullet>>>(
-            packet->Bullets[i].Time.GetTime(packet->Time), packet->Bullets[i].ToBullet(packet->Time), true));
+          EventsHistory::MakeEvent<EventsHistory::Add<Bullet>>(
+            packet->Bullets[i].Time, packet->Bullets[i].ToBullet(), true));
       }
 
-      world.CurrentTime = packet->Time;
+      world.CurrentTick = packet->Time;
     }
   };
 
@@ -170,11 +170,11 @@ void NetworkPeer::HandleAddBullets(const uint8_t* bytes, size_t byte_count)
   std::scoped_lock<std::mutex> lock(EventQueueMutex);
   for (size_t i = 0; i < packet->Count; i++)
   {
-    Bullet bullet = packet->Data[i].ToBullet(world.CurrentTime);
+    Bullet bullet = packet->Data[i].ToBullet();
     world.GetManager<BulletManager>()->UpdateNextBulletID(bullet.ID);
 
     EventQueue +=
-      std::make_shared<EventsHistory::EventData<EventsHistory::Add<Bullet>>>(
+      EventsHistory::MakeEvent<EventsHistory::Add<Bullet>>(
         bullet.Time, bullet, true);
   }
 }
@@ -196,10 +196,8 @@ void NetworkPeer::HandleAddWalls(const uint8_t* bytes, size_t byte_count)
 
     world.GetManager<BulletManager>()->UpdateNextWallID(wall.ID);
 
-    double wall_time = wall.Time.GetTime(world.CurrentTime);
-
     EventQueue.insert(
-      std::make_shared<EventsHistory::EventData<EventsHistory::Add<Wall>>>(
-        wall_time, wall, true));
+      EventsHistory::MakeEvent<EventsHistory::Add<Wall>>(
+        wall.Time, wall, true));
   }
 }
@@ -39,7 +39,7 @@ NetworkServer::NetworkServer(std::mutex& EventQueueMutex,
     World& world = World::Get();
     std::scoped_lock<std::mutex> lock(world.MainLoopMutex);
 
-    const double time = world.CurrentTime;
+    const tick_t time = world.CurrentTick;
 
     const size_t wall_count = world.Walls.size();
     const size_t bullet_count = world.Bullets.size();
@@ -55,7 +55,7 @@ NetworkServer::NetworkServer(std::mutex& EventQueueMutex,
       data->Bullets[i] = { bullet, time };
     });
 
-    data->Time = world.CurrentTime;
+    data->Time = world.CurrentTick;
 
     Send(peer, data.get(), byte_count);
   };
@@ -73,7 +73,7 @@ NetworkServer::NetworkServer(std::mutex& EventQueueMutex,
     {
       World& world = World::Get();
 
-      double min_time = std::numeric_limits<double>::infinity();
+      tick_t min_time = Ticks::Infinity;
 
       const Protocol::Packets::Update<Protocol::BulletDescriptor>* packet = 
         reinterpret_cast<const Protocol::Packets::Update<Protocol::BulletDescriptor>*>(data);
@@ -83,15 +83,15 @@ NetworkServer::NetworkServer(std::mutex& EventQueueMutex,
 
       std::scoped_lock<std::mutex> lock(this->EventQueueMutex);
       size_t index = 0;
-      packet->ForEach([this, &added_bullets, &index, &bullet_manager, &world](const Protocol::BulletDescriptor& bullet, size_t index)
+      packet->ForEach([this, &added_bullets, &bullet_manager](const Protocol::BulletDescriptor& bullet, size_t index)
       {
-        Bullet copy = bullet.ToBullet(world.CurrentTime);
+        Bullet copy = bullet.ToBullet();
         copy.ID = bullet_manager->GetNextBulletID();
 
         added_bullets[index] = bullet;
 
         this->EventQueue.insert(
-          std::make_shared<EventsHistory::EventData<EventsHistory::Add<Bullet>>>(
+          EventsHistory::MakeEvent<EventsHistory::Add<Bullet>>(
             bullet.Time, copy, true));
       });
 
@@ -126,10 +126,9 @@ NetworkServer::NetworkServer(std::mutex& EventQueueMutex,
 
         added_walls[i] = wall;
 
-        double wall_time = wall.Time.GetTime(world.CurrentTime);
         this->EventQueue.insert(
-          std::make_shared<EventsHistory::EventData<EventsHistory::Add<Wall>>>(
-            wall_time, wall, true));
+          EventsHistory::MakeEvent<EventsHistory::Add<Wall>>(
+            wall.Time, wall, true));
       }
 
       size_t update_size;
@@ -21,7 +21,7 @@ bool PollEvents(World& world)
 
   while (SDL_PollEvent(&event))
   {
-    double event_time_point = world.CurrentTime;
+    double event_time_point = world.GetSeconds();
 
     switch (event.type)
     {
@@ -1,9 +1,11 @@
 #pragma once
 
+#include "Math.h"
 #include "Wall.h"
 #include "Bullet.h"
 #include "ProtocolEnums.h"
 
+#include <limits>
 #include <memory>
 #include <functional>
 
@@ -17,7 +19,7 @@ namespace Protocol
     static const uint8_t EntityType = Protocol::EntityType::BULLET;
 
     Bullet::id_t ID = 0;
-    Timestamp<> Time;
+    tick_t Time = 0;
     float Speed = 0;
     float2 Location;
     float2 Direction;
@@ -25,19 +27,19 @@ namespace Protocol
 
     BulletDescriptor() {}
 
-    BulletDescriptor(const Bullet& bullet, double time):
+    BulletDescriptor(const Bullet& bullet, tick_t time):
       ID(bullet.ID),
       Time(time),
       Speed(bullet.Speed),
       Location(bullet.GetLocation(time)),
       Direction(bullet.Direction),
-      Lifetime(bullet.Lifetime - (time - bullet.Time))
+      Lifetime(bullet.Lifetime > 0 ? Max(bullet.Lifetime - float(Ticks::ToSeconds(time - bullet.Time)), std::numeric_limits<float>::min()) : 0)
     {
     }
 
-    Bullet ToBullet(double time) const
+    Bullet ToBullet() const
     {
-      return Bullet(ID, Location, Direction, Speed, Time.GetTime(time), Lifetime);
+      return Bullet(ID, Location, Direction, Speed, Time, Lifetime);
     }
 
     bool operator<(const BulletDescriptor& other) const
@@ -124,7 +126,7 @@ namespace Protocol
     {
       uint8_t Type = PacketType::WORLD_SYNC;
 
-      double Time = 0.0;
+      tick_t Time = 0;
 
       struct
       {
@@ -25,21 +25,23 @@ void RenderBullets(SDL_Renderer* renderer, const float2& render_offset)
 {
   World& world = World::Get();
 
-  double time = world.CurrentTime;
+  const tick_t time = world.CurrentTick;
 
   SDL_SetRenderDrawColor(renderer, Color::WHITE);
 
-  world.Bullets.ForEach([renderer, time, render_offset, &world](const Bullet& bullet, size_t index)
+  const BulletStore& bullets = world.Bullets;
+
+  const Array<float2>& locations = bullets.GetLocations();
+  const Array<float2>& directions = bullets.GetDirections();
+  const Array<float>& speeds = bullets.GetSpeeds();
+  const Array<tick_t>& times = bullets.GetTimes();
+
+  for (size_t i = 0; i < bullets.size(); ++i)
   {
-    if (bullet.GetLocation(time).DistanceTo(world.RenderCenter) > 1000)
-    {
-      world.History.ScheduleEvent<EventsHistory::Remove<Bullet>>(time, bullet);
-    }
-    else
-    {
-      Draw::CircleFilled(renderer, bullet.GetLocation(time) + render_offset, Config::BulletRadius);
-    }
-  });
+    const float2 location = locations[i] + directions[i] * speeds[i] * float(Ticks::ToSeconds(time - times[i]));
+
+    Draw::CircleFilled(renderer, location + render_offset, Config::BulletRadius);
+  }
 }
 
 void RenderDebugHistory(SDL_Renderer* renderer)
@@ -80,10 +82,13 @@ void RenderDebugHistory(SDL_Renderer* renderer)
     SDL_SetRenderDrawColor(renderer, color.WithAlphaf(0.18f));
     Draw::Rect(renderer, { x - hpadding, y - padding * 0.25f }, { max_width, size.y + padding * 0.5f });
 
-    bool is_bullet = std::dynamic_pointer_cast<EventsHistory::EventData<Bullet>>(event) ||
-      std::dynamic_pointer_cast<EventsHistory::EventData<EventsHistory::Update<Bullet>>>(event);
+    const bool is_bullet =
+      event->Tag == EventsHistory::TAG_ADD_BULLET ||
+      event->Tag == EventsHistory::TAG_REMOVE_BULLET ||
+      event->Tag == EventsHistory::TAG_UPDATE_BULLET ||
+      event->Tag == EventsHistory::TAG_BOUNCE;
 
-    bool is_collision = false;
+    const bool is_collision = event->Tag == EventsHistory::TAG_COLLISION;
 
     {
       static const char* scales_pos[] = { " s", " m", " h", " d", " w", " y" };
@@ -107,7 +112,7 @@ void RenderDebugHistory(SDL_Renderer* renderer)
 
       int scale = 0;
 
-      double t = (event->Time - world.CurrentTime);
+      double t = Ticks::ToSeconds(event->Time - world.CurrentTick);
 
       while (Abs(t) < 1.0 && Abs(scale) < 6)
       {
@@ -150,39 +155,7 @@ void RenderDebugHistory(SDL_Renderer* renderer)
       Draw::Text(renderer, { x - hpadding * 2, y }, buf2, size.y, true);
     }
 
-    uint32_t id = [&event, &is_bullet, &is_collision]()
-    {
-      if (is_bullet)
-      {
-        std::shared_ptr<EventsHistory::EventData<Bullet>> event_bullet =
-          std::dynamic_pointer_cast<EventsHistory::EventData<Bullet>>(event);
-        if (event_bullet) return event_bullet->Data.ID;
-
-        std::shared_ptr<EventsHistory::EventData<EventsHistory::Update<Bullet>>> event_bullet_update =
-          std::dynamic_pointer_cast<EventsHistory::EventData<EventsHistory::Update<Bullet>>>(event);
-        if (event_bullet_update) return event_bullet_update->Data.New.ID;
-      }
-      else
-      {
-        std::shared_ptr<EventsHistory::EventData<Wall>> event_wall =
-          std::dynamic_pointer_cast<EventsHistory::EventData<Wall>>(event);
-        if (event_wall) return event_wall->Data.ID;
-
-        std::shared_ptr<EventsHistory::EventData<EventsHistory::Update<Wall>>> event_wall_update =
-          std::dynamic_pointer_cast<EventsHistory::EventData<EventsHistory::Update<Wall>>>(event);
-        if (event_wall_update) return event_wall_update->Data.New.ID;
-
-        std::shared_ptr<EventsHistory::EventData<EventsHistory::Collision>> event_collision =
-          std::dynamic_pointer_cast<EventsHistory::EventData<EventsHistory::Collision>>(event);
-        if (event_collision)
-        {
-          is_collision = true;
-          return event_collision->Data.BulletID;
-        }
-      }
-
-      return uint32_t(0);
-    }();
+    const uint32_t id = EventsHistory::GetEntityID(event);
 
     SDL_SetRenderDrawColor(renderer, color);
 
@@ -203,7 +176,7 @@ void RenderDebugHistory(SDL_Renderer* renderer)
     if (is_collision)
     {
       std::shared_ptr<EventsHistory::EventData<EventsHistory::Collision>> event_collision =
-        std::dynamic_pointer_cast<EventsHistory::EventData<EventsHistory::Collision>>(event);
+        EventsHistory::Cast<EventsHistory::Collision>(event);
 
       static ProceduralTexture sprite(size, 0xFF, renderer, [](const float2& in_uv, Color& pixel)
       {
@@ -239,13 +212,15 @@ void RenderDebugHistory(SDL_Renderer* renderer)
       Draw::CircleFilled(renderer, center, float(size.Max()) * 0.5f - 1.0f);
 
       std::shared_ptr<EventsHistory::EventData<EventsHistory::Update<Bullet>>> event_bullet_update =
-        std::dynamic_pointer_cast<EventsHistory::EventData<EventsHistory::Update<Bullet>>>(event);
-      if (event_bullet_update)
+        EventsHistory::Cast<EventsHistory::Update<Bullet>>(event);
+      std::shared_ptr<EventsHistory::EventData<EventsHistory::Bounce>> event_bullet_bounce =
+        EventsHistory::Cast<EventsHistory::Bounce>(event);
+      if (event_bullet_update || event_bullet_bounce)
       {
         float dir_size = Floor(0.5f * size.y) - 0.75f;
 
-        float2 a = center - event_bullet_update->Data.Old.Direction * dir_size;
-        float2 b = center + event_bullet_update->Data.New.Direction * dir_size;
+        float2 a = center - (event_bullet_update ? event_bullet_update->Data.Old.Direction : event_bullet_bounce->Data.OldDirection) * dir_size;
+        float2 b = center + (event_bullet_update ? event_bullet_update->Data.New.Direction : event_bullet_bounce->Data.Direction) * dir_size;
 
         float thickness = 0.75f;
         bool antialias = true;
@@ -266,7 +241,13 @@ void RenderDebugHistory(SDL_Renderer* renderer)
     return size.y;
   };
 
-  for (auto iter = world.History.EventsQueue.rbegin(); iter != world.History.EventsQueue.rend(); ++iter)
+  const int render_height = world.GetManager<WindowManager>()->RenderResolution.y;
+
+  // latest of the events that fit on screen first
+  const Array<std::shared_ptr<EventsHistory::Event>> queued_events =
+    world.History.EventsQueue.GetSorted(size_t(Max(render_height - y, 0) / (size.y + padding) + 1));
+
+  for (auto iter = queued_events.rbegin(); iter != queued_events.rend(); ++iter)
   {
     if (y >= world.GetManager<WindowManager>()->RenderResolution.y)
       return;
@@ -306,9 +287,9 @@ void RenderDebugOverlay(SDL_Renderer* renderer)
   {
     if (Config::ShowViewCollisions)
     {
-      if (Math2D::CircleLineIntersection(wall.Ends,
+      if (!std::isinf(Math2D::RayCapsuleIntersection(wall.Ends,
         pawn->Location, pawn->Location.DirectionTo(mouse),
-        Config::BulletRadius, 10000, point, normal))
+        Config::BulletRadius, 10000, point, normal)))
       {
         SDL_SetRenderDrawColor(renderer, Color::BLUE);
         Draw::Line(renderer, point + render_offset, point + normal * 25.0f + render_offset, 0.5f);
@@ -368,7 +349,6 @@ void RenderDebugOverlay(SDL_Renderer* renderer)
   {
     bool operator()(Bullet::id_t a, Bullet::id_t b) const
     {
-      double time = World::Get().CurrentTime;
       auto ba = World::Get().Bullets.Get(a);
       auto bb = World::Get().Bullets.Get(b);
       return ba->Collision.Time == bb->Collision.Time
@@ -387,7 +367,7 @@ void RenderDebugOverlay(SDL_Renderer* renderer)
 
     const int font_size = 12;
     
-    float2 text_start_pos = bullet.GetLocation(World::Get().CurrentTime) + render_offset;
+    float2 text_start_pos = bullet.GetLocation(World::Get().CurrentTick) + render_offset;
     text_start_pos.y += Config::BulletRadius;
 
     float2 text_pos = text_start_pos;
@@ -398,7 +378,7 @@ void RenderDebugOverlay(SDL_Renderer* renderer)
     if (!bullet.Collision.Hits) return;
 
     SDL_SetRenderDrawColor(renderer, Color::GREEN);
-    Draw::Line(renderer, bullet.GetLocation(World::Get().CurrentTime) + render_offset, bullet.Collision.Location + render_offset, 0.5f);
+    Draw::Line(renderer, bullet.GetLocation(World::Get().CurrentTick) + render_offset, bullet.Collision.Location + render_offset, 0.5f);
 
     SDL_SetRenderDrawColor(renderer, Color::BLUE.WithAlpha(0xFA));
     Draw::Line(renderer, bullet.Collision.Location + render_offset,
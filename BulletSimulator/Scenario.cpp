@@ -0,0 +1,209 @@
+#include "Common.h"
+
+#include "Scenario.h"
+
+#include "Math.h"
+#include "Wall.h"
+#include "World.h"
+#include "Config.h"
+#include "BulletManager.h"
+
+#include <cmath>
+
+
+static const char* const ScenarioNames[Scenario::TYPE_COUNT] =
+{
+  "random_walls",
+  "grid_maze",
+  "closed_box",
+  "wall_churn",
+};
+
+const char* Scenario::GetName(Type type)
+{
+  return type < TYPE_COUNT ? ScenarioNames[type] : "unknown";
+}
+
+bool Scenario::FindType(const std::string& name, Type& type)
+{
+  for (int i = 0; i < TYPE_COUNT; ++i)
+  {
+    if (name == ScenarioNames[i])
+    {
+      type = Type(i);
+      return true;
+    }
+  }
+  return false;
+}
+
+Scenario::Scenario(Type type, uint32_t seed, size_t bullets, size_t walls) :
+  ScenarioType(type), BulletCount(bullets), WallCount(walls)
+{
+  State = seed * 2654435761u ^ 0x9E3779B9u;
+  if (!State) State = 1;
+}
+
+uint32_t Scenario::Next()
+{
+  // xorshift32
+  State ^= State << 13;
+  State ^= State >> 17;
+  State ^= State << 5;
+  return State;
+}
+
+float Scenario::Uniform(float min, float max)
+{
+  return min + (max - min) * float(Next() >> 8) * (1.0f / 16777216.0f);
+}
+
+float2 Scenario::RandomLocation()
+{
+  return float2(Uniform(AreaMin.x, AreaMax.x), Uniform(AreaMin.y, AreaMax.y));
+}
+
+float2 Scenario::RandomDirection()
+{
+  const float angle = Uniform(0.0f, 6.2831853f);
+  return float2(std::cos(angle), std::sin(angle));
+}
+
+void Scenario::AddWall(World& world, const float2& a, const float2& b)
+{
+  Wall wall(world.GetManager<BulletManager>()->GetNextWallID(), LineSegment(a, b), world.CurrentTick);
+  world.History.ScheduleEvent<EventsHistory::Add<Wall>>(world.CurrentTick, wall);
+}
+
+void Scenario::AddRandomWall(World& world)
+{
+  const float2 start = RandomLocation();
+  AddWall(world, start, start + RandomDirection() * Uniform(10.0f, 200.0f));
+}
+
+void Scenario::FireRandomBullet(World& world)
+{
+  const float2 location = RandomLocation();
+  world.GetManager<BulletManager>()->Fire(location, RandomDirection(),
+    float(Config::BulletSpeed), world.CurrentTick, float(Config::BulletLifetime));
+}
+
+void Scenario::Build(World& world)
+{
+  // closed scenarios keep their bullets inside a fifth of the world bounds
+  const float extent = float(Config::WorldBounds) * (ScenarioType == RANDOM_WALLS ? 0.5f : 0.2f);
+  AreaMin = float2(-extent, -extent);
+  AreaMax = float2(extent, extent);
+
+  switch (ScenarioType)
+  {
+  case RANDOM_WALLS:
+  case WALL_CHURN:
+    for (size_t i = 0; i < WallCount; ++i)
+      AddRandomWall(world);
+    break;
+
+  case GRID_MAZE:
+    BuildMaze(world);
+    break;
+
+  case CLOSED_BOX:
+    AddWall(world, float2(AreaMin.x, AreaMin.y), float2(AreaMax.x, AreaMin.y));
+    AddWall(world, float2(AreaMax.x, AreaMin.y), float2(AreaMax.x, AreaMax.y));
+    AddWall(world, float2(AreaMax.x, AreaMax.y), float2(AreaMin.x, AreaMax.y));
+    AddWall(world, float2(AreaMin.x, AreaMax.y), float2(AreaMin.x, AreaMin.y));
+    break;
+
+  default:
+    break;
+  }
+
+  // bullets are kept off the box walls so none starts on one
+  if (ScenarioType == CLOSED_BOX)
+  {
+    AreaMin += float2(1, 1);
+    AreaMax -= float2(1, 1);
+  }
+
+  for (size_t i = 0; i < BulletCount; ++i)
+    FireRandomBullet(world);
+}
+
+void Scenario::Update(World& world)
+{
+  if (ScenarioType != WALL_CHURN) return;
+
+  // what is scheduled here is added by the next step
+  for (size_t count = world.Walls.size(); count < WallCount; ++count)
+    AddRandomWall(world);
+
+  for (size_t count = world.Bullets.size(); count < BulletCount; ++count)
+    FireRandomBullet(world);
+}
+
+// perfect maze carved by a depth first search, about WallCount walls.
+// bullets can't leave it, so it is dense in collisions and never empties
+void Scenario::BuildMaze(World& world)
+{
+  const size_t size = Max(size_t(2), size_t(std::sqrt(double(WallCount))));
+  const float cell = (AreaMax.x - AreaMin.x) / size;
+
+  // horizontal[y * size + x] is the wall on the low y side of cell (x, y), vertical[y * (size + 1) + x] the one on its low x side
+  Array<bool> horizontal((size + 1) * size, true);
+  Array<bool> vertical(size * (size + 1), true);
+  Array<bool> visited(size * size, false);
+
+  Array<size_t> stack;
+  stack.push_back(0);
+  visited[0] = true;
+
+  while (stack.size())
+  {
+    const size_t current = stack.back();
+    const size_t x = current % size;
+    const size_t y = current / size;
+
+    size_t neighbours[4];
+    size_t count = 0;
+    if (x > 0 && !visited[current - 1]) neighbours[count++] = current - 1;
+    if (x + 1 < size && !visited[current + 1]) neighbours[count++] = current + 1;
+    if (y > 0 && !visited[current - size]) neighbours[count++] = current - size;
+    if (y + 1 < size && !visited[current + size]) neighbours[count++] = current + size;
+
+    if (!count)
+    {
+      stack.pop_back();
+      continue;
+    }
+
+    const size_t next = neighbours[Next() % count];
+
+    if (next == current - 1) vertical[y * (size + 1) + x] = false;
+    else if (next == current + 1) vertical[y * (size + 1) + x + 1] = false;
+    else if (next + size == current) horizontal[y * size + x] = false;
+    else horizontal[(y + 1) * size + x] = false;
+
+    visited[next] = true;
+    stack.push_back(next);
+  }
+
+  for (size_t y = 0; y <= size; ++y)
+  {
+    for (size_t x = 0; x < size; ++x)
+    {
+      if (!horizontal[y * size + x]) continue;
+      const float2 a = AreaMin + float2(x * cell, y * cell);
+      AddWall(world, a, a + float2(cell, 0));
+    }
+  }
+
+  for (size_t y = 0; y < size; ++y)
+  {
+    for (size_t x = 0; x <= size; ++x)
+    {
+      if (!vertical[y * (size + 1) + x]) continue;
+      const float2 a = AreaMin + float2(x * cell, y * cell);
+      AddWall(world, a, a + float2(0, cell));
+    }
+  }
+}
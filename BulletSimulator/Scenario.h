@@ -0,0 +1,80 @@
+#pragma once
+
+#include "Types.h"
+#include "Array.h"
+
+#include <string>
+#include <cstdint>
+
+
+class World;
+
+// reproducible worlds for benchmarks and the headless driver, the same seed builds the same world.
+// random numbers come straight from the engine so they don't depend on the standard library
+class Scenario
+{
+public:
+
+  enum Type
+  {
+    RANDOM_WALLS,  // walls scattered over the world, bullets eventually leave it
+    GRID_MAZE,     // closed maze of square cells, bullets bounce inside forever
+    CLOSED_BOX,    // four walls around all of the bullets
+    WALL_CHURN,    // walls destroyed on hit and put back, lost bullets fired again
+    TYPE_COUNT
+  };
+
+  static const char* GetName(Type type);
+
+  // false if no scenario has that name
+  static bool FindType(const std::string& name, Type& type);
+
+  Scenario(Type type, uint32_t seed, size_t bullets, size_t walls);
+
+  Type GetType() const
+  {
+    return ScenarioType;
+  }
+
+  // the value Config::DestroyWallsOnCollision has to have while the scenario runs, the caller sets it
+  bool DestroysWalls() const
+  {
+    return ScenarioType == WALL_CHURN;
+  }
+
+  // schedules the walls and bullets of the scenario at the current time, the world needs a BulletManager
+  void Build(World& world);
+
+  // to be called between steps
+  void Update(World& world);
+
+private:
+
+  Type ScenarioType;
+
+  size_t BulletCount;
+
+  size_t WallCount;
+
+  uint32_t State;
+
+  // area bullets are fired in
+  float2 AreaMin;
+  float2 AreaMax;
+
+  uint32_t Next();
+
+  float Uniform(float min, float max);
+
+  float2 RandomLocation();
+
+  float2 RandomDirection();
+
+  void AddWall(World& world, const float2& a, const float2& b);
+
+  void AddRandomWall(World& world);
+
+  void FireRandomBullet(World& world);
+
+  void BuildMaze(World& world);
+};
@@ -0,0 +1,240 @@
+#pragma once
+
+#include "Math.h"
+#include "Array.h"
+#include "Types.h"
+#include "LineSegment.h"
+
+#include <cmath>
+#include <limits>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+
+
+// uniform grid hashed by cell coordinates,
+// every segment is registered in all cells it touches when inflated by Padding
+template<typename K>
+class SegmentGrid
+{
+public:
+
+  typedef std::function<bool(const Array<K>& ids, float exit_distance)> RaycastDelegate;
+
+  typedef std::function<void(const K& id)> QueryDelegate;
+
+  explicit SegmentGrid(float cell_size = 64.0f, float padding = 0.0f) :
+    CellSize(cell_size), Padding(padding)
+  {}
+
+  float GetCellSize() const
+  {
+    return CellSize;
+  }
+
+  float GetPadding() const
+  {
+    return Padding;
+  }
+
+  size_t size() const
+  {
+    return Segments.size();
+  }
+
+  void Reset(float cell_size, float padding)
+  {
+    Clear();
+    CellSize = cell_size;
+    Padding = padding;
+  }
+
+  void Clear()
+  {
+    Cells.clear();
+    Segments.clear();
+  }
+
+  void Add(const K& id, const LineSegment& segment)
+  {
+    Remove(id);
+
+    Segments[id] = segment;
+
+    ForEachCell(segment, Padding, [this, &id](int x, int y)
+    {
+      Cells[GetCellKey(x, y)].push_back(id);
+    });
+  }
+
+  bool Remove(const K& id)
+  {
+    auto iter = Segments.find(id);
+
+    if (iter == Segments.end()) return false;
+
+    ForEachCell(iter->second, Padding, [this, &id](int x, int y)
+    {
+      auto cell = Cells.find(GetCellKey(x, y));
+      if (cell == Cells.end()) return;
+
+      Array<K>& ids = cell->second;
+      for (size_t i = 0; i < ids.size(); ++i)
+      {
+        if (ids[i] != id) continue;
+        ids[i] = ids.back();
+        ids.pop_back();
+        break;
+      }
+
+      if (!ids.size()) Cells.erase(cell);
+    });
+
+    Segments.erase(iter);
+    return true;
+  }
+
+  const LineSegment* Get(const K& id) const
+  {
+    auto iter = Segments.find(id);
+    return (iter == Segments.end()) ? nullptr : &iter->second;
+  }
+
+  // visits non-empty cells along the ray in order of distance,
+  // stops when the callback returns false or the range is exceeded
+  void Raycast(const float2& origin, const float2& direction, float range, RaycastDelegate callback) const
+  {
+    int x = GetCellCoordinate(origin.x);
+    int y = GetCellCoordinate(origin.y);
+
+    const int step_x = direction.x < 0 ? -1 : 1;
+    const int step_y = direction.y < 0 ? -1 : 1;
+
+    const float infinity = std::numeric_limits<float>::infinity();
+
+    const float delta_x = direction.x != 0 ? Abs(CellSize / direction.x) : infinity;
+    const float delta_y = direction.y != 0 ? Abs(CellSize / direction.y) : infinity;
+
+    float next_x = direction.x != 0
+      ? ((x + (step_x > 0 ? 1 : 0)) * CellSize - origin.x) / direction.x
+      : infinity;
+    float next_y = direction.y != 0
+      ? ((y + (step_y > 0 ? 1 : 0)) * CellSize - origin.y) / direction.y
+      : infinity;
+
+    while (true)
+    {
+      float exit_distance = Min(Min(next_x, next_y), range);
+
+      auto cell = Cells.find(GetCellKey(x, y));
+      if (cell != Cells.end() && !callback(cell->second, exit_distance)) return;
+
+      if (exit_distance >= range) return;
+
+      if (next_x < next_y)
+      {
+        x += step_x;
+        next_x += delta_x;
+      }
+      else
+      {
+        y += step_y;
+        next_y += delta_y;
+      }
+    }
+  }
+
+  // ids of the cell a ray is in just past its origin or nullptr when the cell is empty,
+  // exit_distance is how far along the ray it leaves that cell.
+  // the origin is nudged forward so a ray starting on a boundary gets the cell ahead
+  const Array<K>* GetCell(const float2& origin, const float2& direction, float& exit_distance) const
+  {
+    const float2 inside = origin + direction * (CellSize * 0.001f);
+
+    const int x = GetCellCoordinate(inside.x);
+    const int y = GetCellCoordinate(inside.y);
+
+    const float infinity = std::numeric_limits<float>::infinity();
+
+    const float exit_x = direction.x != 0
+      ? ((x + (direction.x > 0 ? 1 : 0)) * CellSize - origin.x) / direction.x
+      : infinity;
+    const float exit_y = direction.y != 0
+      ? ((y + (direction.y > 0 ? 1 : 0)) * CellSize - origin.y) / direction.y
+      : infinity;
+
+    exit_distance = Min(exit_x, exit_y);
+
+    auto cell = Cells.find(GetCellKey(x, y));
+    return (cell == Cells.end()) ? nullptr : &cell->second;
+  }
+
+  // calls back every id registered in the cells touched by the segment inflated by padding,
+  // the same id may be reported more than once
+  void Query(const LineSegment& segment, float padding, QueryDelegate callback) const
+  {
+    ForEachCell(segment, padding, [this, &callback](int x, int y)
+    {
+      auto cell = Cells.find(GetCellKey(x, y));
+      if (cell == Cells.end()) return;
+      for (const K& id : cell->second)
+        callback(id);
+    });
+  }
+
+private:
+
+  float CellSize;
+
+  float Padding;
+
+  std::unordered_map<uint64_t, Array<K>> Cells;
+
+  std::unordered_map<K, LineSegment> Segments;
+
+  inline int GetCellCoordinate(float value) const
+  {
+    return int(std::floor(value / CellSize));
+  }
+
+  static inline uint64_t GetCellKey(int x, int y)
+  {
+    return (uint64_t(uint32_t(x)) << 32) | uint64_t(uint32_t(y));
+  }
+
+  // walks cell columns covered by the segment and
+  // visits rows spanned by the part of the segment inside each column
+  template<typename F>
+  void ForEachCell(const LineSegment& segment, float padding, F callback) const
+  {
+    const float2 delta = segment.B - segment.A;
+
+    const int x0 = GetCellCoordinate(Min(segment.A.x, segment.B.x) - padding);
+    const int x1 = GetCellCoordinate(Max(segment.A.x, segment.B.x) + padding);
+
+    for (int x = x0; x <= x1; ++x)
+    {
+      float t0 = 0.0f;
+      float t1 = 1.0f;
+
+      if (delta.x != 0)
+      {
+        const float ta = (x * CellSize - padding - segment.A.x) / delta.x;
+        const float tb = ((x + 1) * CellSize + padding - segment.A.x) / delta.x;
+        t0 = Max(t0, Min(ta, tb));
+        t1 = Min(t1, Max(ta, tb));
+        if (t0 > t1) continue;
+      }
+
+      const float ya = segment.A.y + delta.y * t0;
+      const float yb = segment.A.y + delta.y * t1;
+
+      const int y0 = GetCellCoordinate(Min(ya, yb) - padding);
+      const int y1 = GetCellCoordinate(Max(ya, yb) + padding);
+
+      for (int y = y0; y <= y1; ++y)
+        callback(x, y);
+    }
+  }
+
+};
@@ -5,7 +5,7 @@
 #include <set>
 
 
-template<typename T, class Cmp = std::less<T>>
+template<typename T, class Cmp>
 class Set : public Collection<std::set<T, Cmp>, T>
 {
 public:
@@ -0,0 +1,136 @@
+#include "Common.h"
+
+#include "SlabAllocator.h"
+
+#include "Math.h"
+
+#include <new>
+
+
+std::atomic<size_t> SlabPool::TotalReservedBytes = 0;
+std::atomic<size_t> SlabPool::TotalUsedBytes = 0;
+
+static inline size_t AlignUp(size_t value, size_t align)
+{
+  return (value + align - 1) / align * align;
+}
+
+SlabPool::SlabPool(size_t block_size, size_t block_align) :
+  BlockSize(AlignUp(Max(block_size, sizeof(void*)), Max(block_align, alignof(void*)))),
+  FirstBlockOffset(AlignUp(sizeof(Slab), Max(block_align, alignof(void*)))),
+  BlocksPerSlab((SlabSize - FirstBlockOffset) / BlockSize)
+{
+}
+
+void* SlabPool::Allocate()
+{
+  std::lock_guard<std::mutex> lock{ Mutex };
+
+  if (!Available)
+  {
+    if (Spare)
+    {
+      Available = Spare;
+      Spare = nullptr;
+    }
+    else
+    {
+      PushFront(NewSlab());
+    }
+  }
+
+  Slab* slab = Available;
+
+  void* block;
+  if (slab->FreeList)
+  {
+    block = slab->FreeList;
+    slab->FreeList = *static_cast<void**>(block);
+  }
+  else
+  {
+    block = reinterpret_cast<uint8_t*>(slab) + FirstBlockOffset + slab->Bumped++ * BlockSize;
+  }
+
+  if (++slab->Used == BlocksPerSlab)
+    Unlink(slab);
+
+  UsedBytes += BlockSize;
+  TotalUsedBytes += BlockSize;
+
+  return block;
+}
+
+void SlabPool::Deallocate(void* block)
+{
+  std::lock_guard<std::mutex> lock{ Mutex };
+
+  // slabs are aligned to their size
+  Slab* slab = reinterpret_cast<Slab*>(reinterpret_cast<uintptr_t>(block) & ~uintptr_t(SlabSize - 1));
+
+  if (slab->Used-- == BlocksPerSlab)
+    PushFront(slab);
+
+  *static_cast<void**>(block) = slab->FreeList;
+  slab->FreeList = block;
+
+  UsedBytes -= BlockSize;
+  TotalUsedBytes -= BlockSize;
+
+  if (slab->Used) return;
+
+  Unlink(slab);
+
+  if (Spare) FreeSlab(Spare);
+  Spare = slab;
+}
+
+size_t SlabPool::GetTotalReservedBytes()
+{
+  return TotalReservedBytes;
+}
+
+size_t SlabPool::GetTotalUsedBytes()
+{
+  return TotalUsedBytes;
+}
+
+SlabPool::Slab* SlabPool::NewSlab()
+{
+  Slab* slab = static_cast<Slab*>(::operator new(SlabSize, std::align_val_t(SlabSize)));
+
+  slab->Prev = nullptr;
+  slab->Next = nullptr;
+  slab->FreeList = nullptr;
+  slab->Used = 0;
+  slab->Bumped = 0;
+
+  ReservedBytes += SlabSize;
+  TotalReservedBytes += SlabSize;
+
+  return slab;
+}
+
+void SlabPool::FreeSlab(Slab* slab)
+{
+  ::operator delete(slab, std::align_val_t(SlabSize));
+
+  ReservedBytes -= SlabSize;
+  TotalReservedBytes -= SlabSize;
+}
+
+void SlabPool::Unlink(Slab* slab)
+{
+  if (slab->Prev) slab->Prev->Next = slab->Next;
+  if (slab->Next) slab->Next->Prev = slab->Prev;
+  if (Available == slab) Available = slab->Next;
+  slab->Prev = slab->Next = nullptr;
+}
+
+void SlabPool::PushFront(Slab* slab)
+{
+  slab->Prev = nullptr;
+  slab->Next = Available;
+  if (Available) Available->Prev = slab;
+  Available = slab;
+}
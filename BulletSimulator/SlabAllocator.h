@@ -0,0 +1,130 @@
+#pragma once
+
+#include <mutex>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+
+// fixed size blocks carved out of aligned slabs, a freed block goes back to the
+// free list of its slab and a slab is released as a whole once all its blocks are free.
+// blocks are allocated in time order, so history aging out empties slabs one after another
+class SlabPool
+{
+public:
+
+  static constexpr size_t SlabSize = 64 * 1024;
+
+  SlabPool(size_t block_size, size_t block_align);
+
+  SlabPool(const SlabPool&) = delete;
+  SlabPool& operator=(const SlabPool&) = delete;
+
+  void* Allocate();
+
+  void Deallocate(void* block);
+
+  // bytes of the slabs held by the pool
+  size_t GetReservedBytes() const
+  {
+    return ReservedBytes;
+  }
+
+  // bytes of the blocks in use
+  size_t GetUsedBytes() const
+  {
+    return UsedBytes;
+  }
+
+  // over all pools
+  static size_t GetTotalReservedBytes();
+  static size_t GetTotalUsedBytes();
+
+private:
+
+  struct Slab
+  {
+    Slab* Prev;
+    Slab* Next;
+    void* FreeList;
+    size_t Used;
+    size_t Bumped;
+  };
+
+  const size_t BlockSize;
+  const size_t FirstBlockOffset;
+  const size_t BlocksPerSlab;
+
+  std::mutex Mutex;
+
+  // slabs with free blocks, the one in front is allocated from
+  Slab* Available = nullptr;
+
+  // a fully free slab kept around so a pool hovering at a slab boundary doesn't thrash
+  Slab* Spare = nullptr;
+
+  std::atomic<size_t> ReservedBytes = 0;
+  std::atomic<size_t> UsedBytes = 0;
+
+  static std::atomic<size_t> TotalReservedBytes;
+  static std::atomic<size_t> TotalUsedBytes;
+
+  Slab* NewSlab();
+
+  void FreeSlab(Slab* slab);
+
+  void Unlink(Slab* slab);
+
+  void PushFront(Slab* slab);
+};
+
+// std allocator drawing single objects from a pool per type,
+// used through std::allocate_shared so the object and its control block share a block
+template<typename T>
+class SlabAllocator
+{
+public:
+
+  typedef T value_type;
+
+  SlabAllocator() = default;
+
+  template<typename U>
+  SlabAllocator(const SlabAllocator<U>&) {}
+
+  T* allocate(size_t count)
+  {
+    if (count != 1 || !Fits()) return static_cast<T*>(::operator new(count * sizeof(T)));
+    return static_cast<T*>(GetPool().Allocate());
+  }
+
+  void deallocate(T* pointer, size_t count)
+  {
+    if (count != 1 || !Fits())
+    {
+      ::operator delete(pointer);
+      return;
+    }
+    GetPool().Deallocate(pointer);
+  }
+
+  template<typename U>
+  bool operator==(const SlabAllocator<U>&) const { return true; }
+
+  template<typename U>
+  bool operator!=(const SlabAllocator<U>&) const { return false; }
+
+private:
+
+  static constexpr bool Fits()
+  {
+    return sizeof(T) <= SlabPool::SlabSize / 4 && alignof(T) <= alignof(std::max_align_t);
+  }
+
+  // never destroyed, blocks may be released after static destructors ran
+  static SlabPool& GetPool()
+  {
+    static SlabPool* pool = new SlabPool(sizeof(T), alignof(T));
+    return *pool;
+  }
+};
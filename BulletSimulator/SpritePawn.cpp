@@ -11,6 +11,7 @@
 #include "InputManager.h"
 #include "Vector2Stream.h"
 #include "BulletManager.h"
+#include "NetworkManager.h"
 #include "ProceduralTexture.h"
 
 
@@ -28,8 +29,8 @@ void SpritePawn::Move(const float2& direction)
 float2 SpritePawn::UpdateVelocity(const float2& delta, double delta_time)
 {
   float2 target = {
-    isnan(delta.x) ? 0 : delta.x,
-    isnan(delta.y) ? 0 : delta.y
+    std::isnan(delta.x) ? 0 : delta.x,
+    std::isnan(delta.y) ? 0 : delta.y
   };
   return Velocity = Lerp(Velocity, target, Clamp(Config::Acceleration * delta_time));
 }
@@ -50,7 +51,7 @@ float2 GetWallsResistance(const float2& Location, const float2 Velocity)
 
     float distance = Math2D::DistanceFromPointToLine(wall.Ends, Location);
 
-    if (isnan(distance)) distance = 0.0f;
+    if (std::isnan(distance)) distance = 0.0f;
     if (distance_a < Abs(distance)) distance = distance_a;
     if (distance_b < Abs(distance)) distance = distance_b;
 
@@ -83,12 +84,12 @@ void SpritePawn::ApplyMovement(double delta_time)
     World::Get().Walls.ForEach([&](const Wall& wall)
     {
       float2 point, normal;
-      if (!Math2D::CircleLineIntersection(wall.Ends, Location, Velocity.Normalized(), 5.0f, 100000.0f, point, normal))
+      if (std::isinf(Math2D::RayCapsuleIntersection(wall.Ends, Location, Velocity.Normalized(), 5.0f, 100000.0f, point, normal)))
         return;
 
       float2 axis_time = (point - Location) / Velocity;
-      if (isnan(axis_time.x)) axis_time.x = INFINITY;
-      if (isnan(axis_time.y)) axis_time.y = INFINITY;
+      if (std::isnan(axis_time.x)) axis_time.x = INFINITY;
+      if (std::isnan(axis_time.y)) axis_time.y = INFINITY;
 
       double time_to_hit = (axis_time).Min();
 
@@ -136,7 +137,7 @@ void SpritePawn::ApplyMovement(double delta_time)
 
   Location += Delta * time_left * Config::MovementSpeed;
   MovementVector = float2(0);
-  UpdateFiring(World::Get().CurrentTime + delta_time, last_location);
+  UpdateFiring(World::Get().GetSeconds() + delta_time, last_location);
 }
 
 void SpritePawn::Render(SDL_Renderer * renderer, World & world)
@@ -211,7 +212,9 @@ void SpritePawn::UpdateFiring(double time, const float2 & last_location)
   {
     double fire_time = Fire.LastFireTime + (1.0 / Config::FireRate);
     float2 location = Lerp(last_location, Location, Clamp(delta_time));
-    World::Get().GetManager<BulletManager>()->Fire(location, location.DirectionTo(Fire.Target), Config::BulletSpeed, fire_time, 0);
+    World& world = World::Get();
+    Bullet bullet = world.GetManager<BulletManager>()->Fire(location, location.DirectionTo(Fire.Target), Config::BulletSpeed, Ticks::FromSeconds(fire_time), float(Config::BulletLifetime));
+    world.GetManager<NetworkManager>()->Fire(bullet);
     Fire.LastFireTime = fire_time;
   }
 }
@@ -100,7 +100,7 @@ namespace String
       if (value < 1)
       {
         char fmt[16];
-        int symbols = int(std::ceilf(Max(0.0f, -std::log10(value))) + 1 + ((value < 0.01) ? 1 : 0));
+        int symbols = int(std::ceil(Max(0.0f, -std::log10(value))) + 1 + ((value < 0.01) ? 1 : 0));
         snprintf(fmt, sizeof(fmt), "%%.%df", symbols);
         snprintf(buf, sizeof(buf), fmt, value);
       }
@@ -125,8 +125,8 @@ namespace String
   {
     if (percent == 0) return "0";
 
-    if (isnan(percent)) return "nan";
-    if (isinf(percent)) return "inf";
+    if (std::isnan(percent)) return "nan";
+    if (std::isinf(percent)) return "inf";
 
     char buf[64];
 
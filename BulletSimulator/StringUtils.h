@@ -1,7 +1,8 @@
 #pragma once
 
-#include "Types.h"
+#include "List.h"
 #include "Math.h"
+#include "Types.h"
 
 #include <string>
 #include <numeric>
@@ -72,20 +73,6 @@ namespace String
     return CommonPrefix(strings.begin(), strings.end());
   }
 
-  template<template<class> typename T = List, typename S = std::string>
-  S Join(const T<S>& strings, const S& delimiter = ",")
-  {
-    std::stringstream s;
-    size_t index = 0;
-    for (const S& str : strings)
-    {
-      s << str;
-      if (++index != strings.size())
-        s << delimiter;
-    }
-    return s.str();
-  }
-
   template<typename T, typename S = std::string>
   std::string Join(const T& strings, const S& delimiter = ",")
   {
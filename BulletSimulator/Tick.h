@@ -0,0 +1,39 @@
+#pragma once
+
+#include <limits>
+#include <cstdint>
+
+
+// world time in integer nanoseconds, so times compare and order exactly.
+// seconds only appear at the edges: kinematics, config and display
+typedef int64_t tick_t;
+
+namespace Ticks
+{
+  constexpr tick_t PerSecond = 1000000000;
+
+  // never reached, stands for no time at all
+  constexpr tick_t Infinity = std::numeric_limits<tick_t>::max();
+
+  constexpr double ToSeconds(tick_t ticks)
+  {
+    return ticks == Infinity ? std::numeric_limits<double>::infinity()
+      : ticks == -Infinity ? -std::numeric_limits<double>::infinity()
+      : double(ticks) / double(PerSecond);
+  }
+
+  // rounds to the nearest tick, infinite, nan and out of range times saturate
+  constexpr tick_t FromSeconds(double seconds)
+  {
+    return !(seconds < double(Infinity) / double(PerSecond)) ? Infinity
+      : seconds <= -double(Infinity) / double(PerSecond) ? -Infinity
+      : tick_t(seconds * double(PerSecond) + (seconds < 0 ? -0.5 : 0.5));
+  }
+
+  // the time some seconds later, infinity when either is
+  constexpr tick_t After(tick_t time, double seconds)
+  {
+    const tick_t delta = FromSeconds(seconds);
+    return (time == Infinity || delta == Infinity) ? Infinity : time + delta;
+  }
+}
@@ -0,0 +1,266 @@
+#pragma once
+
+#include "Math.h"
+#include "Tick.h"
+#include "Array.h"
+
+#include <cstdint>
+#include <algorithm>
+#include <unordered_map>
+
+
+// hierarchical timer wheel: Levels rings of SlotCount slots, a slot on level L spans
+// SlotCount^L wheel ticks of Resolution world ticks. entries keep their exact time, wheel ticks only decide placement.
+// scheduling and cancelling are O(1), an entry moves down at most Levels times
+template<typename K>
+class TimerWheel
+{
+public:
+
+  static constexpr int SlotBits = 6;
+  static constexpr uint64_t SlotCount = 1 << SlotBits;
+  static constexpr int Levels = 4;
+
+  explicit TimerWheel(tick_t resolution = Ticks::PerSecond / 128) :
+    Resolution(resolution)
+  {}
+
+  size_t size() const
+  {
+    return Locations.size();
+  }
+
+  void Clear()
+  {
+    for (auto& level : Slots)
+      for (auto& slot : level)
+        slot.clear();
+    Overflow.clear();
+    Locations.clear();
+  }
+
+  // moves the wheel to the time keeping all entries, used after going back in time
+  void Reset(tick_t time)
+  {
+    Array<Entry> entries;
+    entries.reserve(Locations.size());
+
+    ForEachSlot([&entries](Array<Entry>& slot)
+    {
+      entries.insert(entries.end(), slot.begin(), slot.end());
+    });
+
+    Clear();
+    CurrentTick = GetTick(time);
+
+    for (const Entry& entry : entries)
+      Insert(entry);
+  }
+
+  // replaces the entry for the id, times in the past fire on the next Advance
+  void Schedule(const K& id, tick_t time)
+  {
+    Cancel(id);
+
+    if (time == Ticks::Infinity) return;
+
+    Insert({ id, time });
+  }
+
+  bool Cancel(const K& id)
+  {
+    auto iter = Locations.find(id);
+
+    if (iter == Locations.end()) return false;
+
+    Array<Entry>& slot = GetSlot(iter->second);
+    const size_t index = iter->second.Index;
+
+    Locations.erase(iter);
+
+    if (index + 1 != slot.size())
+    {
+      slot[index] = slot.back();
+      Locations[slot[index].ID].Index = index;
+    }
+    slot.pop_back();
+
+    return true;
+  }
+
+  // time the id is scheduled at, infinity if it isn't
+  tick_t GetTime(const K& id) const
+  {
+    auto iter = Locations.find(id);
+
+    if (iter == Locations.end()) return Ticks::Infinity;
+
+    const Location& location = iter->second;
+    const Array<Entry>& slot = location.Level < Levels ? Slots[location.Level][location.Slot] : Overflow;
+
+    return slot[location.Index].Time;
+  }
+
+  // exact time of the earliest entry, infinity when empty
+  tick_t GetNextTime() const
+  {
+    for (int level = 0; level < Levels; ++level)
+    {
+      const uint64_t first = GetSlotIndex(CurrentTick, level) + (level ? 1 : 0);
+
+      for (uint64_t index = first; index < SlotCount; ++index)
+      {
+        const Array<Entry>& slot = Slots[level][index];
+        if (slot.size()) return GetMinTime(slot);
+      }
+    }
+
+    return Overflow.size() ? GetMinTime(Overflow) : Ticks::Infinity;
+  }
+
+  // removes entries due by the time and calls back (id, time) in time order
+  template<typename F>
+  void Advance(tick_t time, F callback)
+  {
+    Array<Entry> due;
+
+    tick_t next_time;
+    while ((next_time = GetNextTime()) <= time)
+    {
+      MoveTo(Max(CurrentTick, GetTick(next_time)));
+
+      Array<Entry>& slot = Slots[0][GetSlotIndex(CurrentTick, 0)];
+      for (size_t i = 0; i < slot.size();)
+      {
+        if (slot[i].Time > time)
+        {
+          ++i;
+          continue;
+        }
+
+        due.push_back(slot[i]);
+        Cancel(slot[i].ID);
+      }
+    }
+
+    MoveTo(Max(CurrentTick, GetTick(time)));
+
+    std::sort(due.begin(), due.end(), [](const Entry& a, const Entry& b)
+    {
+      return (a.Time == b.Time) ? a.ID < b.ID : a.Time < b.Time;
+    });
+
+    for (const Entry& entry : due)
+      callback(entry.ID, entry.Time);
+  }
+
+private:
+
+  struct Entry
+  {
+    K ID;
+    tick_t Time;
+  };
+
+  struct Location
+  {
+    int Level; // Levels for overflow
+    uint64_t Slot;
+    size_t Index;
+  };
+
+  tick_t Resolution;
+
+  uint64_t CurrentTick = 0;
+
+  Array<Entry> Slots[Levels][SlotCount];
+
+  // entries beyond the top level
+  Array<Entry> Overflow;
+
+  std::unordered_map<K, Location> Locations;
+
+  inline uint64_t GetTick(tick_t time) const
+  {
+    return time <= 0 ? 0 : uint64_t(time / Resolution);
+  }
+
+  static inline uint64_t GetSlotIndex(uint64_t tick, int level)
+  {
+    return (tick >> (SlotBits * level)) & (SlotCount - 1);
+  }
+
+  static inline tick_t GetMinTime(const Array<Entry>& entries)
+  {
+    tick_t result = Ticks::Infinity;
+    for (const Entry& entry : entries)
+      result = Min(result, entry.Time);
+    return result;
+  }
+
+  Array<Entry>& GetSlot(const Location& location)
+  {
+    return location.Level < Levels ? Slots[location.Level][location.Slot] : Overflow;
+  }
+
+  template<typename F>
+  void ForEachSlot(F callback)
+  {
+    for (auto& level : Slots)
+      for (auto& slot : level)
+        callback(slot);
+    callback(Overflow);
+  }
+
+  // level is the lowest one whose ring still contains the tick
+  void Insert(const Entry& entry)
+  {
+    const uint64_t tick = Max(GetTick(entry.Time), CurrentTick);
+
+    Location location = { Levels, 0, 0 };
+
+    for (int level = 0; level < Levels; ++level)
+    {
+      if ((tick >> (SlotBits * (level + 1))) == (CurrentTick >> (SlotBits * (level + 1))))
+      {
+        location = { level, GetSlotIndex(tick, level), 0 };
+        break;
+      }
+    }
+
+    Array<Entry>& slot = GetSlot(location);
+    location.Index = slot.size();
+    slot.push_back(entry);
+    Locations[entry.ID] = location;
+  }
+
+  // nothing may be scheduled before the tick,
+  // so only slots that contain it have to be spread over lower levels
+  void MoveTo(uint64_t tick)
+  {
+    if (tick == CurrentTick) return;
+
+    const bool top_level_changed = (tick >> (SlotBits * Levels)) != (CurrentTick >> (SlotBits * Levels));
+
+    CurrentTick = tick;
+
+    Array<Entry> entries;
+
+    if (top_level_changed)
+      entries.swap(Overflow);
+
+    for (int level = Levels - 1; level > 0; --level)
+    {
+      Array<Entry>& slot = Slots[level][GetSlotIndex(tick, level)];
+      entries.insert(entries.end(), slot.begin(), slot.end());
+      slot.clear();
+    }
+
+    for (const Entry& entry : entries)
+    {
+      Locations.erase(entry.ID);
+      Insert(entry);
+    }
+  }
+
+};
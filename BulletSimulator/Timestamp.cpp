@@ -1,8 +0,0 @@
-#include "Common.h"
-
-#include "World.h"
-#include "Timestamp.h"
-
-#include <limits>
-
-
@@ -1,8 +1,8 @@
 #pragma once
 
+#include "Tick.h"
 #include "Vector2.h"
 #include "ProtocolEnums.h"
-#include "Timestamp.h"
 #include "LineSegment.h"
 
 
@@ -14,15 +14,15 @@ struct Wall
 
   id_t ID;
   LineSegment Ends;
-  Timestamp<> Time;
-  
+  tick_t Time;
+
   static const uint8_t EntityType = Protocol::EntityType::WALL;
 
   Wall() :
-    Time(0.0f)
+    Time(0)
   {}
 
-  Wall(const id_t id, const LineSegment& segment, const float time) :
+  Wall(const id_t id, const LineSegment& segment, const tick_t time) :
     ID(id), Ends(segment), Time(time)
   {}
 
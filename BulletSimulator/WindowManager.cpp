@@ -2,6 +2,8 @@
 
 #include "WindowManager.h"
 
+#include "World.h"
+#include "Config.h"
 #include "Logger.h"
 
 #include <SDL.h>
@@ -48,3 +50,8 @@ void WindowManager::ToggleFullscreen()
     Fullscreen();
   }
 }
+
+float2 World::GetRenderOffset()
+{
+  return RenderCenter + GetManager<WindowManager>()->RenderResolution * 0.5f / Config::RenderScale;
+}
@@ -5,9 +5,6 @@
 #include "World.h"
 #include "Config.h"
 #include "BulletManager.h"
-#include "WindowManager.h"
-
-#include <SDL.h>
 
 #include <algorithm>
 #include <execution>
@@ -20,9 +17,15 @@ void World::Reset()
   if (instance)
   {
     instance->Bullets.clear();
+    instance->BulletPathIndex.Clear();
+    instance->WallTargets.clear();
+    instance->BulletTargets.clear();
+    instance->BulletExpiry.Clear();
+    instance->BulletExpiry.Reset(0);
     instance->Walls.clear();
+    instance->WallIndex.Clear();
     instance->History.Clear();
-    instance->CurrentTime = 0;
+    instance->CurrentTick = 0;
     instance->RenderCenter = 0;
     for (auto& pawn : instance->Pawns)
     {
@@ -34,7 +37,7 @@ void World::Reset()
 }
 
 World::World(std::chrono::system_clock::time_point StartTime):
-  StartTimePoint(StartTime), StartTicks(SDL_GetTicks()), CurrentTime(0)
+  StartTimePoint(StartTime), CurrentTick(0)
 {
   instance = this;
 }
@@ -44,21 +47,172 @@ World::~World()
   instance = nullptr;
 }
 
-float2 World::GetRenderOffset()
+Bullet& World::AddBullet(const Bullet& bullet)
+{
+  Bullet& result = Bullets.Add(bullet);
+  UpdateBullet(result);
+  return result;
+}
+
+bool World::RemoveBullet(Bullet::id_t id)
+{
+  BulletPathIndex.Remove(id);
+  RemoveBulletTargets(id);
+  BulletExpiry.Cancel(id);
+  return Bullets.Remove(id);
+}
+
+void World::UpdateBullet(const Bullet& bullet)
+{
+  Bullets.Update(bullet);
+  BulletPathIndex.Add(bullet.ID, bullet.GetPath());
+  UpdateBulletTargets(bullet);
+  BulletExpiry.Schedule(bullet.ID, bullet.GetExpiryTime());
+}
+
+void World::UpdateBulletTargets(const Bullet& bullet)
+{
+  const bool hits = bullet.Collision.Hits && bullet.Collision.WallIDs.size();
+
+  auto iter = BulletTargets.find(bullet.ID);
+
+  if (iter == BulletTargets.end() ? !hits : (hits && iter->second == bullet.Collision.WallIDs))
+    return;
+
+  RemoveBulletTargets(bullet.ID);
+
+  if (!hits) return;
+
+  for (Wall::id_t wall_id : bullet.Collision.WallIDs)
+    WallTargets[wall_id] += bullet.ID;
+
+  BulletTargets[bullet.ID] = bullet.Collision.WallIDs;
+}
+
+void World::RemoveBulletTargets(Bullet::id_t id)
+{
+  auto iter = BulletTargets.find(id);
+
+  if (iter == BulletTargets.end()) return;
+
+  for (Wall::id_t wall_id : iter->second)
+  {
+    auto wall_targets = WallTargets.find(wall_id);
+    if (wall_targets == WallTargets.end()) continue;
+    wall_targets->second.Remove(id);
+    if (!wall_targets->second.size()) WallTargets.erase(wall_targets);
+  }
+
+  BulletTargets.erase(iter);
+}
+
+const Set<Bullet::id_t>* World::GetWallTargets(Wall::id_t id) const
+{
+  auto iter = WallTargets.find(id);
+  return (iter == WallTargets.end()) ? nullptr : &iter->second;
+}
+
+Wall& World::AddWall(const Wall& wall)
+{
+  WallIndex.Add(wall.ID, wall.Ends);
+  return Walls.Add(wall);
+}
+
+bool World::RemoveWall(Wall::id_t id)
 {
-  return RenderCenter + GetManager<WindowManager>()->RenderResolution * 0.5f / Config::RenderScale;
+  WallIndex.Remove(id);
+  return Walls.Remove(id);
 }
 
-void World::Simulate(double time)
+void World::Restore(const Array<Bullet>& bullets, const Array<Wall>& walls)
 {
+  Bullets.clear();
+  BulletPathIndex.Clear();
+  WallTargets.clear();
+  BulletTargets.clear();
+  BulletExpiry.Clear();
+  Walls.clear();
+  WallIndex.Clear();
+
+  for (const Wall& wall : walls)
+    AddWall(wall);
+
+  for (const Bullet& bullet : bullets)
+    AddBullet(bullet);
+}
+
+void World::UpdateIndices()
+{
+  const float cell_size = float(Max(Config::CollisionGridCellSize, 1.0));
+  const float padding = float(Config::BulletRadius);
+
+  if (WallIndex.GetCellSize() != cell_size || WallIndex.GetPadding() != padding)
+  {
+    WallIndex.Reset(cell_size, padding);
+
+    Walls.ForEach([this](Wall& wall)
+    {
+      WallIndex.Add(wall.ID, wall.Ends);
+    });
+  }
+
+  if (BulletPathIndex.GetCellSize() != cell_size)
+  {
+    BulletPathIndex.Reset(cell_size, 0.0f);
+
+    Bullets.ForEach([this](Bullet& bullet)
+    {
+      UpdateBullet(bullet);
+    });
+  }
+
+  if (ExpiryBounds != Config::WorldBounds)
+  {
+    ExpiryBounds = Config::WorldBounds;
+
+    // the paths end at the bounds too
+    Bullets.ForEach([this](Bullet& bullet)
+    {
+      UpdateBullet(bullet);
+    });
+  }
+}
+
+void World::Simulate(tick_t time)
+{
+  UpdateIndices();
+
+  // expired bullets are removed through the history so rewinding brings them back
+  tick_t expiry_time;
+  while ((expiry_time = BulletExpiry.GetNextTime()) <= time)
+  {
+    History.ProcessEventsQueue(expiry_time);
+
+    // events up to the expiry may have moved it
+    if (BulletExpiry.GetNextTime() != expiry_time) continue;
+
+    BulletExpiry.Advance(expiry_time, [this](Bullet::id_t id, tick_t expired_at)
+    {
+      // the events up to it may have gone past an expiry computed earlier
+      const Bullet* bullet = Bullets.Get(id);
+      if (bullet)
+        History.ScheduleEvent<EventsHistory::Remove<Bullet>>(Max(expired_at, CurrentTick), *bullet);
+    });
+
+    History.ProcessEventsQueue(expiry_time);
+  }
+
   History.ProcessEventsQueue(time);
   History.Cleanup();
-  CurrentTime = time;
+  CurrentTick = time;
+  History.UpdateKeyframes();
 }
 
-void World::Rewind(double time)
+void World::Rewind(tick_t time)
 {
+  UpdateIndices();
   History.Rewind(time);
-  
-  CurrentTime = time;
+  BulletExpiry.Reset(time);
+
+  CurrentTick = time;
 }
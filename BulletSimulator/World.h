@@ -1,16 +1,21 @@
 #pragma once
 
 #include "List.h"
+#include "Tick.h"
 #include "Wall.h"
 #include "Types.h"
 #include "Bullet.h"
 #include "Config.h"
 #include "EventsHistory.h"
 #include "IndexMap.h"
+#include "BulletStore.h"
+#include "SegmentGrid.h"
+#include "TimerWheel.h"
 
 #include <mutex>
 #include <chrono>
 #include <functional>
+#include <unordered_map>
 
 
 class World
@@ -21,30 +26,76 @@ private:
 
 public:
 
-  static inline constexpr World& Get()
+  static inline World& Get()
   {
     return *(instance ? instance : (instance = new World()));
   }
 
-  static inline constexpr double& Time()
+  static inline tick_t& Time()
   {
-    return Get().CurrentTime;
+    return Get().CurrentTick;
   }
 
   static void Reset();
   
   const std::chrono::system_clock::time_point StartTimePoint;
 
-  const uint32_t StartTicks;
+  tick_t CurrentTick = 0;
 
-  double CurrentTime = 0.0;
+  // for display and input, the simulation runs on CurrentTick
+  double GetSeconds() const
+  {
+    return Ticks::ToSeconds(CurrentTick);
+  }
 
   explicit World(std::chrono::system_clock::time_point start_time = std::chrono::system_clock::now());
 
   ~World();  
 
-  IndexMap<Bullet::id_t, Bullet> Bullets;
+  BulletStore Bullets;
   IndexMap<Wall::id_t, Wall> Walls;
+
+  SegmentGrid<Wall::id_t> WallIndex;
+
+  SegmentGrid<Bullet::id_t> BulletPathIndex;
+
+  // bullets whose next collision involves the wall
+  std::unordered_map<Wall::id_t, Set<Bullet::id_t>> WallTargets;
+
+  // walls each bullet is registered under in WallTargets
+  std::unordered_map<Bullet::id_t, Set<Wall::id_t>> BulletTargets;
+
+  // lifetime end or world bounds exit of every bullet
+  TimerWheel<Bullet::id_t> BulletExpiry;
+
+  // Config::WorldBounds the expiry times were computed with
+  double ExpiryBounds = Config::WorldBounds;
+
+  Bullet& AddBullet(const Bullet& bullet);
+
+  bool RemoveBullet(Bullet::id_t id);
+
+  // refreshes everything derived from a bullet after it was modified in place
+  void UpdateBullet(const Bullet& bullet);
+
+  const Set<Bullet::id_t>* GetWallTargets(Wall::id_t id) const;
+
+  Wall& AddWall(const Wall& wall);
+
+  bool RemoveWall(Wall::id_t id);
+
+  void UpdateIndices();
+
+  // replaces all bullets and walls, used to go back to a keyframe
+  void Restore(const Array<Bullet>& bullets, const Array<Wall>& walls);
+
+private:
+
+  void UpdateBulletTargets(const Bullet& bullet);
+
+  void RemoveBulletTargets(Bullet::id_t id);
+
+public:
   
   List<class Pawn*> Pawns;
   List<class Manager*> Managers;
@@ -73,6 +124,7 @@ public:
 
   float2 RenderCenter = float2(0, 0);
 
+  // defined next to the window, the headless build has none
   float2 GetRenderOffset();
   
   EventsHistory History;
@@ -81,8 +133,8 @@ public:
   
 public:
 
-  void Simulate(double time);
+  void Simulate(tick_t time);
 
-  void Rewind(double time);
+  void Rewind(tick_t time);
   
 };
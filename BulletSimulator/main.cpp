@@ -241,8 +241,8 @@ int main(int argc, const char** argv)
           {
             wall_template.ID = World::Get().GetManager<BulletManager>()->GetNextWallID();
             wall_template.Ends.B = location;
-            wall_template.Time.SetTime(time);
-            World::Get().History.ScheduleEvent<EventsHistory::Add<Wall>>(time, wall_template);
+            wall_template.Time = Ticks::FromSeconds(time);
+            World::Get().History.ScheduleEvent<EventsHistory::Add<Wall>>(wall_template.Time, wall_template);
             World::Get().GetManager<NetworkManager>()->AddWall(wall_template);
           }
         }
@@ -346,15 +346,15 @@ int main(int argc, const char** argv)
 
       add_label([](std::stringstream& stream)
       {
-        float used_percent = float(World::Get().History.GetTotalSize()) / float(Config::HistoryMaxBytes) * 100.0f;
+        const EventsHistory& history = World::Get().History;
+
+        float used_percent = float(history.GetLogSize()) / float(Config::HistoryMaxBytes) * 100.0f;
+
+        // how far back a rewind can go, less than HistoryMaxAge once the budget is hit
+        std::string diff = String::Format(Ticks::ToSeconds(World::Get().CurrentTick - history.GetRewindHorizon()), 2);
 
-        std::string diff = "0.00";
-        if (World::Get().History.EventsLog.size())
-        {
-          diff = String::Format(World::Get().CurrentTime - World::Get().History.EventsLog.Last()->Time, 2);
-        }
         stream
-          << "   history: " << String::FormatBytes(World::Get().History.GetTotalSize())
+          << "   history: " << String::FormatBytes(history.GetLogSize())
           << " " << String::Format(used_percent, 0) << "%, " << diff << "s";
       });
 
@@ -362,6 +362,7 @@ int main(int argc, const char** argv)
       {
         stream << "    events: "
           << World::Get().History.EventsQueue.size() << " future, "
+          << World::Get().History.EventsQueue.GetCancelledCount() << " stale, "
           << World::Get().History.EventsLog.size() << " past";
       });
 
@@ -376,7 +377,7 @@ int main(int argc, const char** argv)
       {
         float used_percent = float(World::Get().History.GetTotalSize()) / float(Config::HistoryMaxBytes) * 100.0f;
         char str[64];
-        snprintf(str, sizeof(str), "%.2lf", World::Get().CurrentTime);
+        snprintf(str, sizeof(str), "%.2lf", World::Get().GetSeconds());
         stream << "world time: " << std::string(str);
       });
 
@@ -0,0 +1,111 @@
+#include "Common.h"
+
+#include "Tick.h"
+#include "Wall.h"
+#include "World.h"
+#include "Config.h"
+#include "BulletManager.h"
+
+#include <iostream>
+
+
+// everything a Bounce stores or restores, the generation belongs to the history
+static bool IsSameBullet(const Bullet& a, const Bullet& b)
+{
+  return a.ID == b.ID
+    && a.Time == b.Time
+    && a.Location == b.Location
+    && a.Direction == b.Direction
+    && a.Speed == b.Speed
+    && a.Lifetime == b.Lifetime
+    && a.Collision.Hits == b.Collision.Hits
+    && (!a.Collision.Hits || a.Collision.Time == b.Collision.Time)
+    && a.Collision.WallIDs == b.Collision.WallIDs
+    && a.Collision.Location == b.Collision.Location
+    && a.Collision.Direction == b.Collision.Direction
+    && a.Collision.Normal == b.Collision.Normal
+    && a.Collision.HorizonTime == b.Collision.HorizonTime;
+}
+
+static size_t CountBounces(const World& world)
+{
+  size_t count = 0;
+  for (const auto& event : world.History.EventsLog)
+    if (event->Tag == EventsHistory::TAG_BOUNCE) ++count;
+  return count;
+}
+
+// a bullet bounces off a slanted wall at about 1.12 s, the hit is found once it passed the collision horizon.
+// reverting the logged Bounce has to give back the bullet from before the hit, and applying it again the bullet from after it
+int main()
+{
+  World world;
+  World::Reset();
+
+  BulletManager bullet_manager;
+  world.Managers += &bullet_manager;
+
+  Config::DestroyWallsOnCollision = false;
+  Config::BulletLifetime = 0.0;
+
+  const Wall wall(bullet_manager.GetNextWallID(), LineSegment(float2(500, -300), float2(600, 300)), 0);
+  world.History.ScheduleEvent<EventsHistory::Add<Wall>>(0, wall);
+
+  const Bullet fired = bullet_manager.Fire(float2(0, 0), float2(1.0f, 0.1f).Normalized(), float(Config::BulletSpeed), 0, 0.0f);
+
+  const tick_t before_time = Ticks::FromSeconds(1.05);
+  const tick_t after_time = Ticks::FromSeconds(2.0);
+
+  world.Simulate(before_time);
+
+  const Bullet* bullet = world.Bullets.Get(fired.ID);
+  if (!bullet || !bullet->Collision.Hits)
+  {
+    std::cerr << "the bullet isn't going to hit the wall\n";
+    return 1;
+  }
+
+  const Bullet before = *bullet;
+
+  world.Simulate(after_time);
+
+  if (CountBounces(world) != 1)
+  {
+    std::cerr << CountBounces(world) << " bounces logged, expected 1\n";
+    return 1;
+  }
+
+  const Bullet after = *world.Bullets.Get(fired.ID);
+
+  int failures = 0;
+
+  world.Rewind(before_time);
+
+  bullet = world.Bullets.Get(fired.ID);
+  if (!bullet || !IsSameBullet(before, *bullet))
+  {
+    std::cerr << "reverting the bounce didn't restore the bullet from before the hit\n";
+    ++failures;
+  }
+
+  if (CountBounces(world))
+  {
+    std::cerr << "the reverted bounce is still logged\n";
+    ++failures;
+  }
+
+  world.Simulate(after_time);
+
+  bullet = world.Bullets.Get(fired.ID);
+  if (!bullet || !IsSameBullet(after, *bullet))
+  {
+    std::cerr << "applying the bounce again didn't give the bullet from after the hit\n";
+    ++failures;
+  }
+
+  world.Managers.clear();
+
+  Config::DestroyWallsOnCollision = true;
+
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,70 @@
+#include "Common.h"
+
+#include "Math.h"
+#include "World.h"
+#include "Config.h"
+#include "BulletManager.h"
+
+#include <cmath>
+#include <iostream>
+
+
+// shrinks WorldBounds with bullets outside the new bounds. they have to expire at the time of
+// the shrink, not at their last update, which would schedule removals in the past and rewind
+int main()
+{
+  World world;
+  World::Reset();
+
+  BulletManager bullet_manager;
+  world.Managers += &bullet_manager;
+
+  Config::WorldBounds = 5000.0;
+  Config::BulletLifetime = 0.0;
+
+  // a ring of bullets heading outwards, all of them well outside the shrunk bounds later
+  const size_t count = 100;
+  for (size_t i = 0; i < count; ++i)
+  {
+    const float angle = 6.2831853f * float(i) / float(count);
+    const float2 direction(std::cos(angle), std::sin(angle));
+    bullet_manager.Fire(direction * 1000.0f, direction, float(Config::BulletSpeed), 0, 0.0f);
+  }
+
+  const tick_t shrink_time = Ticks::FromSeconds(1.3);
+  world.Simulate(shrink_time);
+
+  if (world.Bullets.size() != count)
+  {
+    std::cerr << "expected " << count << " bullets before the shrink, got " << world.Bullets.size() << "\n";
+    return 1;
+  }
+
+  const double bounds = 500.0;
+  Config::WorldBounds = bounds;
+  world.Simulate(shrink_time + Ticks::FromSeconds(1.0 / 60.0));
+
+  int failures = 0;
+
+  if (world.Bullets.size())
+  {
+    std::cerr << world.Bullets.size() << " bullets outside the bounds weren't removed\n";
+    ++failures;
+  }
+
+  for (const auto& event : world.History.EventsLog)
+  {
+    if (event->Tag == EventsHistory::TAG_REMOVE_BULLET && event->Time < shrink_time)
+    {
+      std::cerr << "bullet removed at " << Ticks::ToSeconds(event->Time) << ", before the shrink at " << Ticks::ToSeconds(shrink_time) << "\n";
+      ++failures;
+      break;
+    }
+  }
+
+  world.Managers.clear();
+
+  Config::WorldBounds = 5000.0;
+
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,209 @@
+#include "Common.h"
+
+#include "Tick.h"
+#include "Array.h"
+#include "MappedRingFile.h"
+
+#include <cstdio>
+#include <iostream>
+
+
+// written to the working directory, removed at the end
+static const char* const Path = "MappedRingFileTest.spill";
+
+// xorshift32, the same sequence on every platform
+struct Random
+{
+  uint32_t State;
+
+  uint32_t Next()
+  {
+    State ^= State << 13;
+    State ^= State >> 17;
+    State ^= State << 5;
+    return State;
+  }
+};
+
+// record i is pushed at time i with bytes that tell it apart from the others
+static Array<uint8_t> MakeRecord(size_t index, size_t count)
+{
+  Array<uint8_t> bytes(count);
+  for (size_t i = 0; i < count; ++i)
+    bytes[i] = uint8_t(index * 31 + i);
+  return bytes;
+}
+
+static bool Push(MappedRingFile& file, Array<Array<uint8_t>>& pushed)
+{
+  const Array<uint8_t>& bytes = pushed.back();
+  return file.Push(tick_t(pushed.size() - 1), bytes.data(), bytes.size());
+}
+
+// the records held have to be the newest ones pushed, with their bytes as pushed
+static bool Check(const char* name, const MappedRingFile& file, const Array<Array<uint8_t>>& pushed)
+{
+  if (!file.size())
+  {
+    std::cerr << name << ": no records held\n";
+    return false;
+  }
+
+  const size_t oldest = size_t(file.GetFrontTime());
+
+  if (file.GetBackTime() != tick_t(pushed.size() - 1) || oldest + file.size() != pushed.size())
+  {
+    std::cerr << name << ": records " << oldest << " to " << file.GetBackTime() << " held, "
+      << file.size() << " of them, the newest is " << pushed.size() - 1 << "\n";
+    return false;
+  }
+
+  size_t used = 0;
+  for (size_t i = oldest; i < pushed.size(); ++i)
+    used += pushed[i].size();
+
+  if (file.GetUsedBytes() != used || used > file.GetCapacity())
+  {
+    std::cerr << name << ": " << file.GetUsedBytes() << " bytes used, expected " << used << "\n";
+    return false;
+  }
+
+  size_t count;
+  const uint8_t* back = file.GetBack(count);
+  if (count != pushed.back().size() || !std::equal(back, back + count, pushed.back().begin()))
+  {
+    std::cerr << name << ": record " << pushed.size() - 1 << " reads back wrong\n";
+    return false;
+  }
+
+  return true;
+}
+
+// pops the newest records and compares their bytes
+static bool PopAndCheck(const char* name, MappedRingFile& file, Array<Array<uint8_t>>& pushed, size_t count)
+{
+  for (size_t i = 0; i < count && file.size() > 1; ++i)
+  {
+    if (!Check(name, file, pushed)) return false;
+
+    file.PopBack();
+    pushed.pop_back();
+  }
+
+  return true;
+}
+
+// 40 byte records in 100 bytes: the third wraps over the first, the fourth overwrites the second.
+// then a record that overlaps the one after the first by a single byte
+static int TestWrap()
+{
+  MappedRingFile file;
+  if (!file.Open(Path, 100))
+  {
+    std::cerr << "wrap: can't map " << Path << "\n";
+    return 1;
+  }
+
+  Array<Array<uint8_t>> pushed;
+
+  for (size_t i = 0; i < 4; ++i)
+  {
+    pushed.push_back(MakeRecord(i, i < 3 ? 40 : 30));
+    Push(file, pushed);
+  }
+
+  if (file.size() != 2 || file.GetFrontTime() != 2)
+  {
+    std::cerr << "wrap: " << file.size() << " records from " << file.GetFrontTime() << " held, expected 2 from 2\n";
+    return 1;
+  }
+
+  if (!Check("wrap", file, pushed)) return 1;
+
+  // larger than the file, nothing changes
+  const Array<uint8_t> large = MakeRecord(4, 101);
+  if (file.Push(4, large.data(), large.size()) || file.size() != 2)
+  {
+    std::cerr << "wrap: a record larger than the file was pushed\n";
+    return 1;
+  }
+
+  if (!PopAndCheck("wrap", file, pushed, 1)) return 1;
+
+  // 40, 40 and 19 bytes, then 41 bytes skip the last byte, wrap and cover the first byte of the second record
+  file.clear();
+  pushed.clear();
+
+  for (size_t i = 0; i < 4; ++i)
+  {
+    pushed.push_back(MakeRecord(i, i < 2 ? 40 : i == 2 ? 19 : 41));
+    Push(file, pushed);
+  }
+
+  if (file.size() != 2 || file.GetFrontTime() != 2)
+  {
+    std::cerr << "wrap: " << file.size() << " records from " << file.GetFrontTime() << " held after a one byte overlap, expected 2 from 2\n";
+    return 1;
+  }
+
+  return PopAndCheck("wrap", file, pushed, 1) ? 0 : 1;
+}
+
+// records of random sizes wrap around the file many times, with some of the newest popped in between
+// the way rewinds take them back
+static int TestSpill()
+{
+  const size_t capacity = 4096;
+  const size_t max_record = 200;
+
+  MappedRingFile file;
+  if (!file.Open(Path, capacity))
+  {
+    std::cerr << "spill: can't map " << Path << "\n";
+    return 1;
+  }
+
+  Array<Array<uint8_t>> pushed;
+  Random random = { 777 };
+
+  size_t pushed_bytes = 0;
+  while (pushed_bytes < 50 * capacity)
+  {
+    const size_t count = 1 + random.Next() % max_record;
+    pushed.push_back(MakeRecord(pushed.size(), count));
+    pushed_bytes += count;
+
+    const size_t held = file.size();
+
+    if (!Push(file, pushed))
+    {
+      std::cerr << "spill: record " << pushed.size() - 1 << " wasn't pushed\n";
+      return 1;
+    }
+
+    if (!Check("spill", file, pushed)) return 1;
+
+    // when it overwrote old records only the tail too short for a record and the rest of the last one overwritten are lost
+    if (file.size() != held + 1 && file.GetUsedBytes() + 2 * max_record < capacity)
+    {
+      std::cerr << "spill: " << file.GetUsedBytes() << " bytes used of " << capacity << "\n";
+      return 1;
+    }
+
+    if (random.Next() % 20 == 0 && !PopAndCheck("spill", file, pushed, 1 + random.Next() % 8)) return 1;
+  }
+
+  return PopAndCheck("spill", file, pushed, SIZE_MAX) ? 0 : 1;
+}
+
+int main()
+{
+  int failures = 0;
+
+  failures += TestWrap();
+  failures += TestSpill();
+
+  std::remove(Path);
+
+  return failures ? 1 : 0;
+}
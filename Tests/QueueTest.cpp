@@ -0,0 +1,202 @@
+#include "Common.h"
+
+#include "Tick.h"
+#include "Array.h"
+#include "EventQueue.h"
+#include "CalendarQueue.h"
+
+#include <set>
+#include <memory>
+#include <utility>
+#include <iostream>
+
+
+struct QueueEvent
+{
+  tick_t Time = 0;
+  uint64_t ID = 0;
+  uint64_t QueueTicket = 0;
+};
+
+typedef std::shared_ptr<QueueEvent> QueueEventPointer;
+
+typedef std::set<std::pair<tick_t, uint64_t>> Reference;
+
+// xorshift32, the same sequence on every platform
+struct Random
+{
+  uint32_t State;
+
+  uint32_t Next()
+  {
+    State ^= State << 13;
+    State ^= State >> 17;
+    State ^= State << 5;
+    return State;
+  }
+};
+
+// mostly near the time, with ties, negative times and both infinities thrown in
+static tick_t GetRandomTime(Random& random, tick_t time)
+{
+  switch (random.Next() % 16)
+  {
+  case 0: return Ticks::Infinity;
+  case 1: return -Ticks::Infinity;
+  case 2: return -tick_t(random.Next() % (10 * Ticks::PerSecond));
+  case 3: return time;
+  default: return time + tick_t(random.Next() % (2 * Ticks::PerSecond));
+  }
+}
+
+// false with the first difference printed
+template<typename Q>
+static bool CheckTop(const char* name, Q& queue, const Reference& reference, size_t step)
+{
+  if (queue.size() != reference.size())
+  {
+    std::cerr << name << ": step " << step << " has " << queue.size() << " events, expected " << reference.size() << "\n";
+    return false;
+  }
+
+  const QueueEventPointer& top = queue.Top();
+
+  if (reference.empty() ? top != nullptr : !top || top->Time != reference.begin()->first || top->ID != reference.begin()->second)
+  {
+    std::cerr << name << ": step " << step << " has the wrong event on top\n";
+    return false;
+  }
+
+  return true;
+}
+
+template<typename Q>
+static bool CheckSorted(const char* name, const Q& queue, const Reference& reference, size_t step)
+{
+  const Array<QueueEventPointer> sorted = queue.GetSorted();
+
+  auto iter = reference.begin();
+  for (const QueueEventPointer& event : sorted)
+  {
+    if (iter == reference.end() || event->Time != iter->first || event->ID != iter->second)
+    {
+      std::cerr << name << ": step " << step << " lists the events out of order\n";
+      return false;
+    }
+    ++iter;
+  }
+
+  return iter == reference.end();
+}
+
+// random pushes, moves, removes and pops checked against a std::set of (Time, ID).
+// the queue grows, churns around the time of the last pop and drains, so compaction and resizing all happen
+template<typename Q>
+static int TestQueue(const char* name)
+{
+  Q queue;
+  Reference reference;
+  Random random = { 12345 };
+
+  Array<QueueEventPointer> events;
+  for (uint64_t id = 0; id < 4096; ++id)
+  {
+    events.push_back(std::make_shared<QueueEvent>());
+    events.back()->ID = id;
+  }
+
+  tick_t time = 0;
+
+  const size_t phase_steps = 40000;
+  for (size_t step = 0; step < 3 * phase_steps; ++step)
+  {
+    const size_t phase = step / phase_steps;
+    const uint32_t action = random.Next() % 1000;
+
+    // per thousand steps, pushes outweigh pops while growing, pops while draining
+    const uint32_t push_share = phase == 0 ? 800 : phase == 1 ? 450 : 150;
+
+    QueueEventPointer& event = events[random.Next() % events.size()];
+
+    if (action < push_share)
+    {
+      // pushed again it moves, the old entry keeps the time it was queued at
+      if (queue.Contains(event)) reference.erase({ event->Time, event->ID });
+
+      event->Time = GetRandomTime(random, time);
+      queue.Push(event);
+      reference.insert({ event->Time, event->ID });
+    }
+    else if (action < push_share + 100)
+    {
+      const bool queued = reference.erase({ event->Time, event->ID }) > 0;
+
+      if (queue.Remove(event) != queued)
+      {
+        std::cerr << name << ": step " << step << " removing event " << event->ID << " returned " << !queued << "\n";
+        return 1;
+      }
+    }
+    else if (action < push_share + 102)
+    {
+      const uint64_t remainder = random.Next() % 7;
+      queue.RemoveIf([remainder](const QueueEventPointer& event)
+      {
+        return event->ID % 7 == remainder;
+      });
+
+      for (auto iter = reference.begin(); iter != reference.end();)
+        iter = (iter->second % 7 == remainder) ? reference.erase(iter) : std::next(iter);
+    }
+    else
+    {
+      if (!CheckTop(name, queue, reference, step)) return 1;
+
+      const QueueEventPointer popped = queue.Pop();
+
+      if (reference.empty()) continue;
+
+      reference.erase(reference.begin());
+
+      if (queue.Contains(popped))
+      {
+        std::cerr << name << ": step " << step << " popped event " << popped->ID << " is still queued\n";
+        return 1;
+      }
+
+      // later pushes stay near the popped time, the way the simulation schedules
+      if (popped->Time != Ticks::Infinity && popped->Time != -Ticks::Infinity) time = popped->Time;
+    }
+
+    if (!CheckTop(name, queue, reference, step)) return 1;
+
+    if (step % 1000 == 0 && !CheckSorted(name, queue, reference, step)) return 1;
+  }
+
+  size_t step = 3 * phase_steps;
+  while (reference.size())
+  {
+    if (!CheckTop(name, queue, reference, step++)) return 1;
+
+    queue.Pop();
+    reference.erase(reference.begin());
+  }
+
+  if (queue.size() || queue.Pop())
+  {
+    std::cerr << name << ": events left after draining\n";
+    return 1;
+  }
+
+  return 0;
+}
+
+int main()
+{
+  int failures = 0;
+
+  failures += TestQueue<EventQueue<QueueEvent>>("EventQueue");
+  failures += TestQueue<CalendarQueue<QueueEvent>>("CalendarQueue");
+
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,190 @@
+#include "Common.h"
+
+#include "Tick.h"
+#include "World.h"
+#include "Config.h"
+#include "Scenario.h"
+#include "BulletManager.h"
+
+#include <iostream>
+#include <algorithm>
+
+
+// what has to come out the same whichever way the world got to a time
+struct BulletState
+{
+  Bullet::id_t ID;
+  tick_t Time;
+  float2 Location;
+  float2 Direction;
+
+  // as stored in the timer wheel
+  tick_t ExpiryTime;
+};
+
+static const tick_t StepTicks = Ticks::FromSeconds(1.0 / 60.0);
+
+// bullets leave the world bounds between these, so some of them expire in between
+static const tick_t RewindTime = 300 * StepTicks;
+static const tick_t EndTime = 480 * StepTicks;
+
+static Array<BulletState> GetStates(World& world)
+{
+  Array<BulletState> states;
+
+  world.Bullets.ForEach([&world, &states](Bullet& bullet)
+  {
+    states.push_back({ bullet.ID, bullet.Time, bullet.Location, bullet.Direction, world.BulletExpiry.GetTime(bullet.ID) });
+  });
+
+  std::sort(states.begin(), states.end(), [](const BulletState& a, const BulletState& b)
+  {
+    return a.ID < b.ID;
+  });
+
+  return states;
+}
+
+// false with the first difference printed
+static bool Compare(const char* name, const Array<BulletState>& expected, const Array<BulletState>& actual)
+{
+  if (expected.size() != actual.size())
+  {
+    std::cerr << name << ": " << actual.size() << " bullets, expected " << expected.size() << "\n";
+    return false;
+  }
+
+  for (size_t i = 0; i < expected.size(); ++i)
+  {
+    const BulletState& a = expected[i];
+    const BulletState& b = actual[i];
+
+    if (a.ID != b.ID || a.Time != b.Time || !(a.Location == b.Location) || !(a.Direction == b.Direction))
+    {
+      std::cerr << name << ": bullet " << b.ID << " differs from bullet " << a.ID << " expected\n";
+      return false;
+    }
+
+    if (a.ExpiryTime != b.ExpiryTime)
+    {
+      std::cerr << name << ": bullet " << a.ID << " expires at " << Ticks::ToSeconds(b.ExpiryTime)
+        << ", expected " << Ticks::ToSeconds(a.ExpiryTime) << "\n";
+      return false;
+    }
+  }
+
+  return true;
+}
+
+static void Simulate(World& world, tick_t from, tick_t to)
+{
+  for (tick_t time = from + StepTicks; time <= to; time += StepTicks)
+    world.Simulate(time);
+}
+
+// runs the scenario to the end, rewinds it to the time, from a keyframe or reverting every event,
+// and simulates it again up to the replay time
+static Array<BulletState> Run(bool keyframes, tick_t rewind_time, tick_t replay_time, bool& used_keyframe)
+{
+  World world;
+  World::Reset();
+
+  BulletManager bullet_manager;
+  world.Managers += &bullet_manager;
+
+  Config::KeyframeEventRatio = keyframes ? 1.0 : 1e12;
+
+  Scenario scenario(Scenario::RANDOM_WALLS, 1, 1000, 200);
+  Config::DestroyWallsOnCollision = scenario.DestroysWalls();
+  scenario.Build(world);
+
+  Simulate(world, 0, EndTime);
+
+  // the rewind takes the keyframe when reverting would take more events than it holds
+  used_keyframe = false;
+  for (const Keyframe& keyframe : world.History.Keyframes)
+  {
+    if (keyframe.Time >= rewind_time) continue;
+
+    size_t revert_count = 0;
+    for (const auto& event : world.History.EventsLog)
+    {
+      if (event->Time < rewind_time) break;
+      ++revert_count;
+    }
+
+    used_keyframe = revert_count > keyframe.Bullets.size() + keyframe.Walls.size();
+  }
+
+  if (rewind_time < EndTime)
+  {
+    world.Rewind(rewind_time);
+    Simulate(world, rewind_time, replay_time);
+  }
+
+  Array<BulletState> states = GetStates(world);
+
+  world.Managers.clear();
+
+  return states;
+}
+
+static int TestKeyframeRewind()
+{
+  bool used_keyframe;
+
+  const Array<BulletState> reverted = Run(false, RewindTime, RewindTime, used_keyframe);
+
+  if (used_keyframe)
+  {
+    std::cerr << "keyframe rewind: a keyframe was taken with keyframes off\n";
+    return 1;
+  }
+
+  const Array<BulletState> restored = Run(true, RewindTime, RewindTime, used_keyframe);
+
+  if (!used_keyframe)
+  {
+    std::cerr << "keyframe rewind: no keyframe to rewind to\n";
+    return 1;
+  }
+
+  return Compare("keyframe rewind", reverted, restored) ? 0 : 1;
+}
+
+// simulating again after a rewind has to end where the run without it did
+static int TestRoundTrip()
+{
+  bool used_keyframe;
+
+  const Array<BulletState> expected = Run(true, EndTime, EndTime, used_keyframe);
+
+  const Array<BulletState> restored = Run(true, RewindTime, EndTime, used_keyframe);
+
+  if (!used_keyframe)
+  {
+    std::cerr << "round trip: no keyframe to rewind to\n";
+    return 1;
+  }
+
+  int failures = Compare("round trip from a keyframe", expected, restored) ? 0 : 1;
+
+  const Array<BulletState> reverted = Run(false, RewindTime, EndTime, used_keyframe);
+
+  failures += Compare("round trip reverting events", expected, reverted) ? 0 : 1;
+
+  return failures;
+}
+
+int main()
+{
+  int failures = 0;
+
+  failures += TestKeyframeRewind();
+  failures += TestRoundTrip();
+
+  Config::KeyframeEventRatio = 1.0;
+  Config::DestroyWallsOnCollision = true;
+
+  return failures ? 1 : 0;
+}